@@ -0,0 +1,76 @@
+﻿// Масштабирование многопоточного накопления от 1 до 64 потоков: Fraction под
+// std::mutex, AtomicFraction (CAS) и ConcurrentFractionSum (шарды по потокам).
+// То же сравнение, что в разделе 13 демонстрации, но без windows.h.
+//
+//   AtomicFractionBenchmark [сложений]   - всего сложений на каждое число потоков
+//                                          (по умолчанию 2^20)
+//
+// Завершается с ошибкой, если суммы трех способов разошлись.
+
+#include "AtomicFraction.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Время работы threadCount потоков, выполняющих body(номер потока), в миллисекундах
+    template<typename Body>
+    double measureThreads(int threadCount, Body body) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; i++) {
+            threads.emplace_back(body, i);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(finish - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const long long totalAdds = argc > 1 ? std::atoll(argv[1]) : 1 << 20;
+    const Fraction half(1, 2);
+    bool mismatch = false;
+
+    std::printf("AtomicFraction без блокировок: %s\n", AtomicFraction::isLockFree() ? "да" : "нет");
+    // Ширина в байтах: кириллица в UTF-8 занимает по два
+    std::printf("%14s %16s %16s %16s\n", "потоки", "mutex, мс", "atomic, мс", "sharded, мс");
+    for (int threadCount = 1; threadCount <= 64; threadCount *= 2) {
+        const long long perThread = totalAdds / threadCount;
+
+        Fraction locked;
+        std::mutex lockedGuard;
+        double lockedTime = measureThreads(threadCount, [&](int) {
+            for (long long i = 0; i < perThread; i++) {
+                std::lock_guard<std::mutex> lock(lockedGuard);
+                locked += half;
+            }
+        });
+
+        AtomicFraction atomic;
+        double atomicTime = measureThreads(threadCount, [&](int) {
+            for (long long i = 0; i < perThread; i++) {
+                atomic += half;
+            }
+        });
+
+        ConcurrentFractionSum sharded;
+        double shardedTime = measureThreads(threadCount, [&](int) {
+            for (long long i = 0; i < perThread; i++) {
+                sharded += half;
+            }
+        });
+
+        if (locked != atomic.load() || locked != sharded.sum()) {
+            std::fprintf(stderr, "Расхождение сумм при %d потоках\n", threadCount);
+            mismatch = true;
+        }
+        std::printf("%8d %14.2f %14.2f %14.2f\n", threadCount, lockedTime, atomicTime, shardedTime);
+    }
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
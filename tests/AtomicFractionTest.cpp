@@ -0,0 +1,229 @@
+﻿// Тест AtomicFraction и ConcurrentFractionSum: многопоточная сумма точна и при
+// числе потоков больше ConcurrentFractionSum::shardCount (часть потоков пишет
+// через общий AtomicFraction), sum() во время записи возвращает согласованные
+// значения, исключение оставляет значение без изменений, а шард завершившегося
+// потока достается новому. Главный поток не вызывает add(), чтобы не занимать шард.
+
+#include "AtomicFraction.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace {
+    const int64_t int64Max = std::numeric_limits<int64_t>::max();
+
+    uint64_t checkCount = 0;
+    uint64_t failureCount = 0;
+
+    void expect(bool condition, const char* check) {
+        checkCount++;
+        if (!condition) {
+            failureCount++;
+            std::fprintf(stderr, "FAIL %s\n", check);
+        }
+    }
+
+    template<typename Operation>
+    bool throwsCode(Operation operation, FractionError code) {
+        try {
+            operation();
+        }
+        catch (const FractionException& e) {
+            return e.code() == code;
+        }
+        return false;
+    }
+
+    // Слагаемое номер index потока thread: 1/6, 1/3 или 1/2, чтобы знаменатель шарда менялся
+    int64_t sixths(int thread, int index) {
+        return 1 + (thread + index) % 3;
+    }
+
+    // threadCount писателей по addsPerThread сложений; потоки не завершаются, пока
+    // не закончат все, поэтому при threadCount > shardCount шарда хватает ровно
+    // shardCount из них. Параллельно читатель проверяет, что sum() не убывает,
+    // не превосходит итог и кратна 1/6 - разорванное чтение шарда это нарушит
+    void checkSum(int threadCount, int addsPerThread) {
+        int64_t expectedSixths = 0;
+        for (int t = 0; t < threadCount; t++) {
+            for (int i = 0; i < addsPerThread; i++) {
+                expectedSixths += sixths(t, i);
+            }
+        }
+        const Fraction expected(expectedSixths, 6);
+
+        ConcurrentFractionSum sum;
+        std::atomic<int> withoutShard{ 0 };
+        std::atomic<bool> writing{ true };
+        std::latch finished(threadCount);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < threadCount; t++) {
+            writers.emplace_back([&, t] {
+                for (int i = 0; i < addsPerThread; i++) {
+                    sum += Fraction(sixths(t, i), 6);
+                }
+                if (!ConcurrentFractionSum::hasOwnShard()) {
+                    withoutShard++;
+                }
+                finished.arrive_and_wait();
+            });
+        }
+
+        uint64_t polls = 0;
+        bool monotonic = true;
+        bool bounded = true;
+        bool consistent = true;
+        std::thread reader([&] {
+            Fraction previous;
+            while (writing.load()) {
+                Fraction current = sum.sum();
+                monotonic = monotonic && current >= previous;
+                bounded = bounded && current <= expected;
+                consistent = consistent && 6 % current.getDenominator() == 0;
+                previous = current;
+                polls++;
+            }
+        });
+
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        writing = false;
+        reader.join();
+
+        const int shardCount = static_cast<int>(ConcurrentFractionSum::shardCount);
+        int expectedWithoutShard = threadCount > shardCount ? threadCount - shardCount : 0;
+        std::printf("Потоков: %d, без шарда: %d, чтений sum(): %llu\n",
+            threadCount, withoutShard.load(), static_cast<unsigned long long>(polls));
+        expect(sum.sum() == expected, "ConcurrentFractionSum: точная сумма");
+        expect(withoutShard == expectedWithoutShard, "ConcurrentFractionSum: потоки сверх shardCount без шарда");
+        expect(polls > 0, "sum() во время записи: было хотя бы одно чтение");
+        expect(monotonic, "sum() во время записи: не убывает");
+        expect(bounded, "sum() во время записи: не больше итога");
+        expect(consistent, "sum() во время записи: кратна 1/6");
+    }
+
+    // compareExchange: успех, неудача с обновлением expected и CAS-цикл из нескольких потоков
+    void checkCompareExchange() {
+        AtomicFraction value(Fraction(1, 2));
+        Fraction expected(1, 2);
+        expect(value.compareExchange(expected, Fraction(3, 4)), "compareExchange: успех");
+        expect(value.load() == Fraction(3, 4), "compareExchange: новое значение записано");
+
+        Fraction stale(1, 2);
+        expect(!value.compareExchange(stale, Fraction(5, 6)), "compareExchange: неудача");
+        expect(stale == Fraction(3, 4), "compareExchange: expected получает текущее значение");
+        expect(value.load() == Fraction(3, 4), "compareExchange: значение не изменилось");
+
+        const int threadCount = 8;
+        const int addsPerThread = 20000;
+        AtomicFraction counter;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < addsPerThread; i++) {
+                    Fraction current = counter.load();
+                    while (!counter.compareExchange(current, current + Fraction(1, 3))) {
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        expect(counter.load() == Fraction(threadCount * addsPerThread, 3), "compareExchange: CAS-цикл без потерь");
+    }
+
+    // Переполнение в fetchAdd и операторах не меняет хранимое значение
+    void checkOverflow() {
+        AtomicFraction value{ Fraction(int64Max) };
+        expect(throwsCode([&] { value.fetchAdd(Fraction(1)); }, FractionError::AdditionOverflow),
+            "fetchAdd: AdditionOverflow");
+        expect(value.load() == Fraction(int64Max), "fetchAdd: значение не изменилось");
+        expect(throwsCode([&] { value *= Fraction(2); }, FractionError::MultiplicationOverflow),
+            "operator*=: MultiplicationOverflow");
+        expect(throwsCode([&] { value.fetchDiv(Fraction()); }, FractionError::DivisionByZero),
+            "fetchDiv: DivisionByZero");
+        expect(value.load() == Fraction(int64Max), "operator*=, fetchDiv: значение не изменилось");
+        expect(value.fetchSub(Fraction(1)) == Fraction(int64Max) && value.load() == Fraction(int64Max - 1),
+            "fetchSub: возвращает прежнее значение");
+
+        ConcurrentFractionSum sum;
+        std::thread writer([&] {
+            sum.add(Fraction(int64Max));
+            expect(throwsCode([&] { sum.add(Fraction(1)); }, FractionError::AdditionOverflow),
+                "ConcurrentFractionSum::add: AdditionOverflow");
+        });
+        writer.join();
+        expect(sum.sum() == Fraction(int64Max), "ConcurrentFractionSum::add: шард не изменился");
+    }
+
+    // Все шарды заняты: лишний поток пишет через общий AtomicFraction; после выхода
+    // одного владельца его шард достается следующему потоку, и прежняя сумма шарда сохраняется
+    void checkShardReuse() {
+        const int shardCount = static_cast<int>(ConcurrentFractionSum::shardCount);
+        ConcurrentFractionSum sum;
+        std::atomic<int> owners{ 0 };
+        std::atomic<bool> releaseFirst{ false };
+        std::atomic<bool> releaseAll{ false };
+        std::latch ready(shardCount);
+        std::vector<std::thread> holders;
+        for (int t = 0; t < shardCount; t++) {
+            holders.emplace_back([&, t] {
+                sum.add(Fraction(1));
+                if (ConcurrentFractionSum::hasOwnShard()) {
+                    owners++;
+                }
+                ready.count_down();
+                std::atomic<bool>& release = t == 0 ? releaseFirst : releaseAll;
+                release.wait(false);
+            });
+        }
+        ready.wait();
+        expect(owners == shardCount, "повторное использование шарда: все шарды заняты");
+
+        bool extraOwnsShard = true;
+        std::thread extra([&] {
+            sum.add(Fraction(1, 2));
+            extraOwnsShard = ConcurrentFractionSum::hasOwnShard();
+        });
+        extra.join();
+        expect(!extraOwnsShard, "повторное использование шарда: лишний поток без шарда");
+
+        releaseFirst = true;
+        releaseFirst.notify_one();
+        holders[0].join();
+
+        bool nextOwnsShard = false;
+        std::thread next([&] {
+            sum.add(Fraction(1, 3));
+            nextOwnsShard = ConcurrentFractionSum::hasOwnShard();
+        });
+        next.join();
+        expect(nextOwnsShard, "повторное использование шарда: новый поток получил освободившийся шард");
+
+        releaseAll = true;
+        releaseAll.notify_all();
+        for (int t = 1; t < shardCount; t++) {
+            holders[t].join();
+        }
+        expect(sum.sum() == Fraction(shardCount) + Fraction(1, 2) + Fraction(1, 3),
+            "повторное использование шарда: сумма сохранилась");
+    }
+}
+
+int main() {
+    checkSum(8, 100000);
+    checkSum(static_cast<int>(ConcurrentFractionSum::shardCount) + 36, 10000);
+    checkCompareExchange();
+    checkOverflow();
+    checkShardReuse();
+
+    std::printf("Проверок: %llu, ошибок: %llu\n",
+        static_cast<unsigned long long>(checkCount), static_cast<unsigned long long>(failureCount));
+    return failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,245 @@
+﻿// Бенчмарк основных операций Fraction с проверкой регрессии.
+//
+//   FractionBenchmark                          - вывести результаты
+//   FractionBenchmark --write FILE             - записать базовую линию
+//   FractionBenchmark --baseline FILE [--threshold 0.3]
+//                                              - завершиться с ошибкой, если операция
+//                                                медленнее базовой линии больше чем на порог
+//
+// Скорость операции сравнивается не в абсолютных числах, а относительно
+// опорного цикла (деление double на тех же данных), который измеряется
+// непосредственно перед каждым запуском операции; берется медиана отношений.
+// Так сравнение меньше зависит от частоты и загрузки хоста, но не от микроархитектуры:
+// соотношение 128-битного деления, gcd и деления double на разных процессорах разное.
+// Поэтому базовая линия действительна только для машины, на которой записана, и на
+// новой машине ее нужно перезаписать (--write) перед включением проверки в ctest
+// (FRACTION_BENCHMARK_GATE=ON).
+// Формат базовой линии: строки "имя относительная_скорость", '#' - комментарий.
+
+#include "Fraction.h"
+#include "FractionConvert.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr std::size_t valueCount = 4096;
+    constexpr int repetitions = 9;      // Запусков каждой операции; запуски разных операций чередуются
+    constexpr double runSeconds = 0.02; // Минимальная длительность одного запуска
+
+    // Не дает компилятору выбросить вычисления
+    volatile int64_t sink;
+
+    struct Result {
+        std::string name;
+        std::function<int64_t()> pass;      // Один проход по valueCount значениям
+        double opsPerSecond;                // Лучший результат
+        std::vector<double> ratios;         // Отношения к опорному циклу по запускам
+        double relative;                    // Медиана ratios
+    };
+
+    // Дроби умеренного размера: операции над ними не переполняются
+    std::vector<Fraction> makeValues(uint64_t seed) {
+        std::mt19937_64 random(seed);
+        std::vector<Fraction> values;
+        values.reserve(valueCount);
+        for (std::size_t i = 0; i < valueCount; i++) {
+            int64_t numerator = static_cast<int64_t>(random() % 2000001) - 1000000;
+            uint64_t denominator = 1 + random() % 1000000;
+            values.emplace_back(numerator, denominator);
+        }
+        return values;
+    }
+
+    // Проход, вызывающий body(i) для каждого значения; body встраивается в цикл
+    template<typename Body>
+    std::function<int64_t()> perElement(Body body) {
+        return [body]() {
+            int64_t accumulator = 0;
+            for (std::size_t i = 0; i < valueCount; i++) {
+                accumulator += body(i);
+            }
+            return accumulator;
+        };
+    }
+
+    // Столбец цен x/100: после сокращения знаменатели 1, 2, 4, 5, ..., 100 вперемешку
+    std::vector<Fraction> makePrices(uint64_t seed) {
+        std::mt19937_64 random(seed);
+        std::vector<Fraction> values;
+        values.reserve(valueCount);
+        for (std::size_t i = 0; i < valueCount; i++) {
+            values.emplace_back(static_cast<int64_t>(random() % 2000001) - 1000000, 100);
+        }
+        return values;
+    }
+
+    // Операций в секунду за один запуск не короче runSeconds
+    double measure(const std::function<int64_t()>& pass) {
+        auto start = std::chrono::steady_clock::now();
+        int64_t accumulator = 0;
+        uint64_t operations = 0;
+        double seconds = 0.0;
+        do {
+            accumulator += pass();
+            operations += valueCount;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < runSeconds);
+        sink = accumulator;
+        return static_cast<double>(operations) / seconds;
+    }
+
+    std::map<std::string, double> readBaseline(const char* path) {
+        std::map<std::string, double> baseline;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string name;
+            double rate = 0.0;
+            if (fields >> name >> rate) {
+                baseline[name] = rate;
+            }
+        }
+        return baseline;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* baselinePath = nullptr;
+    const char* writePath = nullptr;
+    double threshold = 0.3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--baseline") == 0) {
+            baselinePath = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--write") == 0) {
+            writePath = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0) {
+            threshold = std::atof(argv[i + 1]);
+        }
+    }
+
+    std::vector<Fraction> a = makeValues(1);
+    std::vector<Fraction> b = makeValues(2);
+    std::vector<int64_t> numerators(valueCount);
+    std::vector<uint64_t> denominators(valueCount);
+    for (std::size_t i = 0; i < valueCount; i++) {
+        numerators[i] = a[i].getNumerator() * 977;
+        denominators[i] = b[i].getDenominator() * 991;
+    }
+
+    // Пакетные преобразования и поэлементный цикл, с которым сравнивается toFixedPoint
+    std::vector<Fraction> prices = makePrices(3);
+    std::vector<double> doubles(valueCount);
+    std::vector<int64_t> cents(valueCount);
+    auto centsLoop = [&](std::size_t i) {
+        int64_t scaled = prices[i].getNumerator() * 100;
+        int64_t den = static_cast<int64_t>(prices[i].getDenominator());
+        int64_t quotient = scaled / den;
+        int64_t twiceRemainder = 2 * std::abs(scaled % den);
+        if (twiceRemainder > den || (twiceRemainder == den && quotient % 2 != 0)) {
+            quotient += scaled < 0 ? -1 : 1;
+        }
+        return quotient;
+    };
+
+    std::vector<Result> results = {
+        { "reference", perElement([&](std::size_t i) {
+            return static_cast<int64_t>(static_cast<double>(numerators[i]) / static_cast<double>(denominators[i]) * 1e6);
+        }), 0.0, {}, 0.0 },
+        { "add", perElement([&](std::size_t i) { return (a[i] + b[i]).getNumerator(); }), 0.0, {}, 0.0 },
+        { "subtract", perElement([&](std::size_t i) { return (a[i] - b[i]).getNumerator(); }), 0.0, {}, 0.0 },
+        { "multiply", perElement([&](std::size_t i) { return (a[i] * b[i]).getNumerator(); }), 0.0, {}, 0.0 },
+        { "divide", perElement([&](std::size_t i) { return b[i].getNumerator() == 0 ? 0 : (a[i] / b[i]).getNumerator(); }), 0.0, {}, 0.0 },
+        { "less", perElement([&](std::size_t i) { return static_cast<int64_t>(a[i] < b[i]); }), 0.0, {}, 0.0 },
+        { "construct", perElement([&](std::size_t i) { return Fraction(numerators[i], denominators[i]).getNumerator(); }), 0.0, {}, 0.0 },
+        { "toDouble", perElement([&](std::size_t i) { return static_cast<int64_t>(static_cast<double>(a[i]) * 1e6); }), 0.0, {}, 0.0 },
+        { "toFloat", perElement([&](std::size_t i) { return static_cast<int64_t>(static_cast<float>(a[i]) * 1e3f); }), 0.0, {}, 0.0 },
+        { "toInt64", perElement([&](std::size_t i) { return static_cast<int64_t>(a[i]); }), 0.0, {}, 0.0 },
+        { "toDoubleBatch", [&]() {
+            FractionConvert::toDouble(a, doubles);
+            return static_cast<int64_t>(doubles[valueCount / 2] * 1e6);
+        }, 0.0, {}, 0.0 },
+        { "toFixedPointLoop", perElement(centsLoop), 0.0, {}, 0.0 },
+        { "toFixedPointBatch", [&]() {
+            FractionConvert::toFixedPoint(prices, cents, 2, RoundingMode::HalfEven);
+            return cents[valueCount / 2];
+        }, 0.0, {}, 0.0 },
+    };
+
+    // Первый проход - прогрев. Опорный цикл (results[0]) измеряется перед каждой операцией
+    Result& reference = results[0];
+    for (int run = 0; run <= repetitions; run++) {
+        for (Result& result : results) {
+            if (&result == &reference) {
+                continue;
+            }
+            double referenceRate = measure(reference.pass);
+            double rate = measure(result.pass);
+            if (run > 0) {
+                result.opsPerSecond = std::max(result.opsPerSecond, rate);
+                reference.opsPerSecond = std::max(reference.opsPerSecond, referenceRate);
+                result.ratios.push_back(rate / referenceRate);
+            }
+        }
+    }
+    reference.relative = 1.0;
+    for (Result& result : results) {
+        if (!result.ratios.empty()) {
+            std::sort(result.ratios.begin(), result.ratios.end());
+            result.relative = result.ratios[result.ratios.size() / 2];
+        }
+    }
+
+    for (const Result& result : results) {
+        std::printf("%-18s %14.0f оп/с %10.4f\n", result.name.c_str(), result.opsPerSecond, result.relative);
+    }
+
+    if (writePath != nullptr) {
+        std::ofstream file(writePath);
+        file << "# Базовая линия FractionBenchmark: операция и скорость относительно опорного цикла\n";
+        for (const Result& result : results) {
+            if (&result != &results[0]) {
+                file << result.name << ' ' << result.relative << '\n';
+            }
+        }
+        std::printf("Базовая линия записана в %s\n", writePath);
+    }
+
+    int regressions = 0;
+    if (baselinePath != nullptr) {
+        std::map<std::string, double> baseline = readBaseline(baselinePath);
+        if (baseline.empty()) {
+            std::fprintf(stderr, "Не удалось прочитать базовую линию %s\n", baselinePath);
+            return EXIT_FAILURE;
+        }
+        for (const Result& result : results) {
+            auto entry = baseline.find(result.name);
+            if (entry == baseline.end()) {
+                continue;
+            }
+            double ratio = result.relative / entry->second;
+            if (ratio < 1.0 - threshold) {
+                std::fprintf(stderr, "РЕГРЕССИЯ %s: %.4f против %.4f (%.0f%%)\n",
+                    result.name.c_str(), result.relative, entry->second, ratio * 100.0);
+                regressions++;
+            }
+        }
+        std::printf("Регрессий: %d (порог %.0f%%)\n", regressions, threshold * 100.0);
+    }
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
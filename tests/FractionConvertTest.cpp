@@ -0,0 +1,276 @@
+﻿// Тест точности пакетных преобразований FractionConvert.
+// toDouble/toFloat проверяются на корректное округление, toFixedPoint/toInteger -
+// на совпадение с точным округлением во всех режимах. Входные массивы содержат
+// повторяющиеся знаменатели, чтобы проверить деление через обратную величину,
+// и блоки малых значений с редкими большими - для векторного цикла toDouble/toFloat.
+// Аргумент: число случайных массивов (по умолчанию 200).
+
+#include "FractionConvert.h"
+#include "FractionOracle.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+    const int64_t int64Max = std::numeric_limits<int64_t>::max();
+    const int64_t int64Min = std::numeric_limits<int64_t>::min();
+
+    const RoundingMode allModes[] = {
+        RoundingMode::Floor, RoundingMode::Ceil, RoundingMode::Trunc,
+        RoundingMode::HalfEven, RoundingMode::HalfAwayFromZero,
+    };
+
+    uint64_t checkCount = 0;
+    uint64_t failureCount = 0;
+
+    void fail(const char* check, const Fraction& value, int scaleDigits, RoundingMode mode, const char* detail) {
+        failureCount++;
+        if (failureCount <= 20) {
+            std::fprintf(stderr, "FAIL %s %lld/%llu scale=%d mode=%d: %s\n", check,
+                static_cast<long long>(value.getNumerator()),
+                static_cast<unsigned long long>(value.getDenominator()),
+                scaleDigits, static_cast<int>(mode), detail);
+        }
+    }
+
+    // Точное round(value * scale) в заданном режиме; false, если не помещается в int64_t
+    bool referenceRound(const Fraction& value, uint64_t scale, RoundingMode mode, int64_t& result) {
+        WideInt numerator = WideInt::fromInt64(value.getNumerator()) * WideInt::fromUInt64(scale);
+        WideInt denominator = WideInt::fromUInt64(value.getDenominator());
+        WideInt remainder;
+        WideInt quotient = numerator.divide(denominator, remainder);
+
+        if (!remainder.isZero()) {
+            bool negative = numerator.isNegative();
+            WideInt step = WideInt::fromInt64(negative ? -1 : 1);
+            int half = WideInt::compare(remainder.abs().shiftLeft(1), denominator);
+            bool away = false;
+            switch (mode) {
+            case RoundingMode::Floor:
+                away = negative;
+                break;
+            case RoundingMode::Ceil:
+                away = !negative;
+                break;
+            case RoundingMode::Trunc:
+                away = false;
+                break;
+            case RoundingMode::HalfEven:
+                away = half > 0 || (half == 0 && quotient.isOdd());
+                break;
+            case RoundingMode::HalfAwayFromZero:
+                away = half >= 0;
+                break;
+            }
+            if (away) {
+                quotient = quotient + step;
+            }
+        }
+        return quotient.toInt64(result);
+    }
+
+    uint64_t powerOfTen(int digits) {
+        uint64_t scale = 1;
+        for (int i = 0; i < digits; i++) {
+            scale *= 10;
+        }
+        return scale;
+    }
+
+    // Поэлементная сверка toFixedPoint; при исключении проверяется, что элемент
+    // на месте сбоя действительно не помещается, и остаток массива проверяется заново
+    void checkFixedPoint(const std::vector<Fraction>& input, int scaleDigits, RoundingMode mode) {
+        uint64_t scale = powerOfTen(scaleDigits);
+        std::size_t begin = 0;
+        while (begin < input.size()) {
+            std::span<const Fraction> part(input.data() + begin, input.size() - begin);
+            std::vector<int64_t> output(part.size());
+            std::size_t failedAt = part.size();
+            try {
+                FractionConvert::toFixedPoint(part, output, scaleDigits, mode);
+            }
+            catch (const FractionException& e) {
+                // Первый элемент, который по эталону не помещается, должен совпасть с местом сбоя
+                failedAt = 0;
+                int64_t expected = 0;
+                while (failedAt < part.size() && referenceRound(part[failedAt], scale, mode, expected)) {
+                    failedAt++;
+                }
+                checkCount++;
+                if (failedAt == part.size() || e.code() != FractionError::ConversionOverflow) {
+                    fail("toFixedPoint", part[0], scaleDigits, mode, "лишнее исключение");
+                    return;
+                }
+            }
+            for (std::size_t i = 0; i < failedAt; i++) {
+                checkCount++;
+                int64_t expected = 0;
+                if (!referenceRound(part[i], scale, mode, expected)) {
+                    fail("toFixedPoint", part[i], scaleDigits, mode, "ожидалось ConversionOverflow");
+                }
+                else if (output[i] != expected) {
+                    fail("toFixedPoint", part[i], scaleDigits, mode, "неверное округление");
+                }
+            }
+            begin += failedAt + 1;
+        }
+    }
+
+    void checkInteger(const std::vector<Fraction>& input, RoundingMode mode) {
+        std::vector<int64_t> output(input.size());
+        try {
+            FractionConvert::toInteger(input, output, mode);
+        }
+        catch (const FractionException&) {
+            checkCount++;
+            fail("toInteger", input[0], 0, mode, "лишнее исключение");
+            return;
+        }
+        for (std::size_t i = 0; i < input.size(); i++) {
+            checkCount++;
+            int64_t expected = 0;
+            if (!referenceRound(input[i], 1, mode, expected) || output[i] != expected) {
+                fail("toInteger", input[i], 0, mode, "неверное округление");
+            }
+            if (mode == RoundingMode::Trunc && output[i] != static_cast<int64_t>(input[i])) {
+                fail("toInteger", input[i], 0, mode, "расходится со static_cast<int64_t>");
+            }
+        }
+    }
+
+    void checkAll(const std::vector<Fraction>& input, FractionOracle& oracle) {
+        std::vector<double> doubles(input.size());
+        std::vector<float> floats(input.size());
+        FractionConvert::toDouble(input, doubles);
+        FractionConvert::toFloat(input, floats);
+        for (std::size_t i = 0; i < input.size(); i++) {
+            oracle.checkRounded("toDouble", input[i], doubles[i]);
+            oracle.checkRounded("toFloat", input[i], floats[i]);
+        }
+        for (RoundingMode mode : allModes) {
+            checkInteger(input, mode);
+            for (int scaleDigits : { 0, 1, 2, 6, 9, 18 }) {
+                checkFixedPoint(input, scaleDigits, mode);
+            }
+        }
+    }
+
+    // Дроби с общим знаменателем: повторы для кэша обратных величин
+    void appendRun(std::vector<Fraction>& values, std::mt19937_64& random, uint64_t den, std::size_t length) {
+        for (std::size_t i = 0; i < length; i++) {
+            int64_t numerator;
+            switch (random() % 3) {
+            case 0:
+                numerator = static_cast<int64_t>(random());
+                break;
+            case 1:
+                // Значение из [-den, den], для больших знаменателей - любое
+                numerator = den < (uint64_t{ 1 } << 62)
+                    ? static_cast<int64_t>(random() % (2 * den + 1)) - static_cast<int64_t>(den)
+                    : static_cast<int64_t>(random());
+                break;
+            default:
+                // Ровно половина и соседние значения
+                numerator = static_cast<int64_t>(den / 2) * (random() % 2 == 0 ? 1 : -1) + static_cast<int64_t>(random() % 3) - 1;
+                break;
+            }
+            // Сокращение меняет знаменатель; серия сохраняется для несократимых числителей
+            values.emplace_back(numerator, den);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long long arrays = argc > 1 ? std::atoll(argv[1]) : 200;
+    FractionOracle oracle;
+
+    // Граничные значения и известные ошибки
+    std::vector<Fraction> edges = {
+        Fraction(0), Fraction(1), Fraction(-1), Fraction(int64Max), Fraction(int64Min),
+        Fraction(int64Min, 3), Fraction(int64Max, 2), Fraction(1, static_cast<uint64_t>(int64Max)),
+        Fraction(-1, static_cast<uint64_t>(int64Max)), Fraction(5, 2), Fraction(-5, 2), Fraction(7, 2),
+        Fraction(-7, 2), Fraction(1, 3), Fraction(-2, 3),
+        Fraction((int64_t{ 1 } << 53) - 1 - (int64_t{ 1 } << 28), (uint64_t{ 1 } << 53) - 1),
+        Fraction((int64_t{ 1 } << 24) + 1, 1), Fraction((int64_t{ 1 } << 25) + 3, 2),
+        Fraction(int64Max, uint64_t{ 1 } << 62), Fraction(int64Min + 1, uint64_t{ 1 } << 40),
+        Fraction(123456789, 1000), Fraction(-123456789, 1000),
+    };
+    // Границы векторного цикла toDouble/toFloat (2^24 и 2^50)
+    for (int digits : { 24, 50 }) {
+        int64_t limit = int64_t{ 1 } << digits;
+        for (int64_t numerator : { limit - 1, limit, limit + 1, -limit - 1, -limit, 1 - limit }) {
+            for (uint64_t den : { uint64_t{ 3 }, static_cast<uint64_t>(limit), static_cast<uint64_t>(limit) + 1 }) {
+                edges.emplace_back(numerator, den);
+            }
+        }
+    }
+    // Граница |num| <= INT64_MAX / 10^k, до которой toFixedPoint умножает без 128 бит
+    for (int scaleDigits : { 1, 2, 6, 9, 18 }) {
+        int64_t limit = int64Max / static_cast<int64_t>(powerOfTen(scaleDigits));
+        for (int64_t numerator : { limit, limit + 1, -limit, -limit - 1 }) {
+            for (uint64_t den : { 1, 2, 3 }) {
+                edges.emplace_back(numerator, den);
+            }
+        }
+    }
+    checkAll(edges, oracle);
+
+    // Размеры массивов и масштаб
+    std::vector<int64_t> shortOutput(edges.size() - 1);
+    std::vector<double> shortDoubles(edges.size() - 1);
+    int rejected = 0;
+    try { FractionConvert::toFixedPoint(edges, shortOutput, 2); }
+    catch (const FractionException& e) { rejected += e.code() == FractionError::SizeMismatch; }
+    try { FractionConvert::toDouble(edges, shortDoubles); }
+    catch (const FractionException& e) { rejected += e.code() == FractionError::SizeMismatch; }
+    std::vector<int64_t> output(edges.size());
+    try { FractionConvert::toFixedPoint(edges, output, 19); }
+    catch (const FractionException& e) { rejected += e.code() == FractionError::InvalidScale; }
+    try { FractionConvert::toFixedPoint(edges, output, -1); }
+    catch (const FractionException& e) { rejected += e.code() == FractionError::InvalidScale; }
+    checkCount++;
+    if (rejected != 4) {
+        failureCount++;
+        std::fprintf(stderr, "FAIL неверные размеры или масштаб не отвергнуты\n");
+    }
+
+    std::mt19937_64 random(4242);
+    const uint64_t denominators[] = {
+        1, 2, 3, 7, 10, 100, 1000, 1000000007, (uint64_t{ 1 } << 32) + 1,
+        (uint64_t{ 1 } << 53) - 1, static_cast<uint64_t>(int64Max),
+    };
+    for (long long i = 0; i < arrays; i++) {
+        std::vector<Fraction> values;
+        while (values.size() < 256) {
+            uint64_t den = random() % 2 == 0
+                ? denominators[random() % std::size(denominators)]
+                : 1 + (random() >> (2 + random() % 62));
+            appendRun(values, random, den, 1 + random() % 16);
+        }
+        checkAll(values, oracle);
+    }
+
+    // Несколько блоков малых значений; большие элементы редки, и часть блоков
+    // целиком проходит векторным циклом
+    for (long long i = 0; i < arrays / 4; i++) {
+        std::vector<Fraction> values;
+        for (int j = 0; j < 1000; j++) {
+            if (random() % 400 == 0) {
+                values.emplace_back(static_cast<int64_t>(random()), 1 + (random() >> (1 + random() % 63)));
+            }
+            else {
+                int64_t numerator = static_cast<int64_t>(random() % 2000001) - 1000000;
+                values.emplace_back(numerator * static_cast<int64_t>(random() % 1000 + 1), 1 + random() % 100000);
+            }
+        }
+        checkAll(values, oracle);
+    }
+
+    checkCount += oracle.checks();
+    failureCount += oracle.failures();
+    std::printf("Проверок: %llu, ошибок: %llu\n",
+        static_cast<unsigned long long>(checkCount), static_cast<unsigned long long>(failureCount));
+    return failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
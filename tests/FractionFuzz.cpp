@@ -0,0 +1,82 @@
+﻿// Fuzz-цель Fraction для libFuzzer: входные байты превращаются в две дроби
+// и число double, результат сверяется с FractionOracle. При расхождении
+// вызывается abort, чтобы fuzzer сохранил вход.
+//
+// Без libFuzzer (FRACTION_FUZZ_STANDALONE) файл собирается в обычную программу:
+// аргументы - файлы корпуса, без аргументов проверяются случайные входы.
+
+#include "FractionOracle.h"
+#include <cstddef>
+#include <cstring>
+
+namespace {
+    template<typename T>
+    T take(const uint8_t*& data, std::size_t& size) {
+        T value{};
+        std::size_t count = size < sizeof(T) ? size : sizeof(T);
+        std::memcpy(&value, data, count);
+        data += count;
+        size -= count;
+        return value;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+    FractionOracle oracle(true);
+
+    int64_t aNumerator = take<int64_t>(data, size);
+    uint64_t aDenominator = take<uint64_t>(data, size);
+    int64_t bNumerator = take<int64_t>(data, size);
+    uint64_t bDenominator = take<uint64_t>(data, size);
+    double value = take<double>(data, size);
+
+    Fraction a, b;
+    bool hasA = oracle.checkConstruction(aNumerator, aDenominator, a);
+    bool hasB = oracle.checkConstruction(bNumerator, bDenominator, b);
+    if (hasA) {
+        oracle.checkUnary(a);
+    }
+    if (hasA && hasB) {
+        oracle.checkBinary(a, b);
+    }
+    oracle.checkFromDouble(value);
+    return 0;
+}
+
+#ifdef FRACTION_FUZZ_STANDALONE
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            std::ifstream file(argv[i], std::ios::binary);
+            std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        std::printf("Проверено файлов: %d\n", argc - 1);
+        return 0;
+    }
+
+    // Случайные входы с короткими значениями, чтобы чаще попадать в границы
+    std::mt19937_64 random(7);
+    uint8_t input[40];
+    for (int i = 0; i < 200000; i++) {
+        for (uint8_t& byte : input) {
+            byte = static_cast<uint8_t>(random());
+        }
+        for (std::size_t field = 0; field < sizeof(input) / 8; field++) {
+            std::size_t kept = random() % 9;
+            std::memset(input + field * 8 + kept, random() % 2 == 0 ? 0x00 : 0xFF, 8 - kept);
+        }
+        LLVMFuzzerTestOneInput(input, sizeof(input));
+    }
+    std::printf("Проверено случайных входов: 200000\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,385 @@
+﻿#ifndef FRACTION_ORACLE_H
+#define FRACTION_ORACLE_H
+
+// Эталонные проверки Fraction на 256-битной арифметике WideInt.
+// Общие для свойства-теста и fuzz-цели: каждая проверка сравнивает
+// результат операции с точным значением и требует исключение
+// тогда и только тогда, когда сокращенный результат не помещается в дробь.
+
+#include "Fraction.h"
+#include "WideInt.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+class FractionOracle {
+public:
+    // Точная сокращенная дробь, знаменатель > 0
+    struct Exact {
+        WideInt numerator;
+        WideInt denominator;
+    };
+
+private:
+    bool abortOnFailure;
+    uint64_t checkCount;
+    uint64_t failureCount;
+
+    static constexpr uint64_t reportLimit = 20;
+
+    static WideInt wide(int64_t value) { return WideInt::fromInt64(value); }
+    static WideInt wide(uint64_t value) { return WideInt::fromUInt64(value); }
+    static WideInt wide(const Fraction& value) { return wide(value.getNumerator()); }
+
+    static Exact exactOf(const Fraction& value) {
+        return Exact{ wide(value.getNumerator()), wide(value.getDenominator()) };
+    }
+
+    static Exact makeExact(WideInt numerator, WideInt denominator) {
+        if (denominator.isNegative()) {
+            numerator = -numerator;
+            denominator = -denominator;
+        }
+        WideInt divisor = WideInt::gcd(numerator, denominator);
+        WideInt remainder;
+        if (!divisor.isZero()) {
+            numerator = numerator.divide(divisor, remainder);
+            denominator = denominator.divide(divisor, remainder);
+        }
+        if (numerator.isZero()) {
+            denominator = wide(int64_t{ 1 });
+        }
+        return Exact{ numerator, denominator };
+    }
+
+    // Помещается ли точное значение в Fraction (знаменатель не больше INT64_MAX)
+    static bool fits(const Exact& value, int64_t& numerator, uint64_t& denominator) {
+        int64_t den = 0;
+        if (!value.numerator.toInt64(numerator) || !value.denominator.toInt64(den)) {
+            return false;
+        }
+        denominator = static_cast<uint64_t>(den);
+        return true;
+    }
+
+    void fail(const char* check, const Fraction* a, const Fraction* b, const char* detail) {
+        failureCount++;
+        if (failureCount <= reportLimit) {
+            std::fprintf(stderr, "FAIL %s", check);
+            if (a != nullptr) {
+                std::fprintf(stderr, " a=%lld/%llu", static_cast<long long>(a->getNumerator()),
+                    static_cast<unsigned long long>(a->getDenominator()));
+            }
+            if (b != nullptr) {
+                std::fprintf(stderr, " b=%lld/%llu", static_cast<long long>(b->getNumerator()),
+                    static_cast<unsigned long long>(b->getDenominator()));
+            }
+            std::fprintf(stderr, ": %s\n", detail);
+        }
+        if (abortOnFailure) {
+            std::abort();
+        }
+    }
+
+    // Результат операции: либо дробь, либо код исключения
+    template<typename Operation>
+    static bool run(Operation operation, Fraction& result, FractionError& code) {
+        try {
+            result = operation();
+            return true;
+        }
+        catch (const FractionException& e) {
+            code = e.code();
+            return false;
+        }
+    }
+
+    // Общая проверка: исключение с кодом overflowCode тогда и только тогда,
+    // когда точный результат не помещается, иначе совпадение с ним
+    template<typename Operation>
+    void expect(const char* check, const Fraction* a, const Fraction* b,
+                const Exact& exact, FractionError overflowCode, Operation operation) {
+        checkCount++;
+        Fraction result;
+        FractionError code = FractionError::Count;
+        bool completed = run(operation, result, code);
+        int64_t numerator = 0;
+        uint64_t denominator = 1;
+        bool representable = fits(exact, numerator, denominator);
+
+        if (!representable) {
+            if (completed) {
+                fail(check, a, b, "ожидалось исключение, результат не помещается");
+            }
+            else if (code != overflowCode) {
+                fail(check, a, b, "неверный код исключения");
+            }
+        }
+        else if (!completed) {
+            fail(check, a, b, "лишнее исключение, результат помещается");
+        }
+        else if (result.getNumerator() != numerator || result.getDenominator() != denominator) {
+            fail(check, a, b, "неверный результат");
+        }
+    }
+
+public:
+    explicit FractionOracle(bool abortOnFailure = false)
+        : abortOnFailure(abortOnFailure), checkCount(0), failureCount(0) {}
+
+    uint64_t checks() const { return checkCount; }
+    uint64_t failures() const { return failureCount; }
+
+    // Корректное округление к ближайшему (к четному при равенстве):
+    // value = significand * 2^exponent должно лежать между серединами
+    // соседних интервалов вокруг точного |numerator| / denominator
+    template<typename Floating>
+    void checkRounded(const char* check, const Fraction& a, Floating value) {
+        checkCount++;
+        constexpr int digits = std::numeric_limits<Floating>::digits;
+        WideInt numerator = wide(a.getNumerator()).abs();
+        WideInt denominator = wide(a.getDenominator());
+
+        if (numerator.isZero() || value == 0) {
+            if (!(numerator.isZero() && value == 0 && !std::signbit(value))) {
+                fail(check, &a, nullptr, "ноль должен переходить в +0 и только он");
+            }
+            return;
+        }
+        if (std::signbit(value) != (a.getNumerator() < 0) || !std::isfinite(value)) {
+            fail(check, &a, nullptr, "неверный знак или не конечное значение");
+            return;
+        }
+
+        int exponent = 0;
+        Floating fraction = std::frexp(std::fabs(value), &exponent);
+        uint64_t significand = static_cast<uint64_t>(std::ldexp(fraction, digits));
+        exponent -= digits;
+        bool powerOfTwo = significand == (uint64_t{ 1 } << (digits - 1));
+
+        // Сравниваем 4 * |x| = 4 * numerator / denominator с границами (4M +- 2) * 2^exponent
+        WideInt upper = wide(4 * significand + 2);
+        WideInt lower = wide(4 * significand - (powerOfTwo ? 1 : 2));
+        WideInt scaledNumerator = numerator;
+        if (exponent - 2 >= 0) {
+            denominator = denominator.shiftLeft(exponent - 2);
+        }
+        else {
+            scaledNumerator = scaledNumerator.shiftLeft(2 - exponent);
+        }
+        WideInt upperBound = upper * denominator;
+        WideInt lowerBound = lower * denominator;
+        bool even = (significand & 1) == 0;
+
+        bool belowUpper = even ? scaledNumerator <= upperBound : scaledNumerator < upperBound;
+        bool aboveLower = even ? scaledNumerator >= lowerBound : scaledNumerator > lowerBound;
+        if (!belowUpper || !aboveLower) {
+            fail(check, &a, nullptr, "результат округлен некорректно");
+        }
+    }
+
+    // Конструктор: нулевой знаменатель и знаменатель больше INT64_MAX отвергаются,
+    // остальное сокращается. Возвращает true, если дробь построена
+    bool checkConstruction(int64_t numerator, uint64_t denominator, Fraction& result) {
+        checkCount++;
+        FractionError code = FractionError::Count;
+        bool completed = run([&] { return Fraction(numerator, denominator); }, result, code);
+        Fraction input = Fraction(numerator);
+
+        if (denominator == 0 || denominator > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+            FractionError expected = denominator == 0 ? FractionError::ZeroDenominator
+                                                      : FractionError::ConversionOverflow;
+            if (completed || code != expected) {
+                fail("Fraction(n, d)", &input, nullptr, "знаменатель должен быть отвергнут");
+            }
+            return false;
+        }
+
+        Exact exact = makeExact(wide(numerator), wide(denominator));
+        int64_t expectedNumerator = 0;
+        uint64_t expectedDenominator = 1;
+        fits(exact, expectedNumerator, expectedDenominator);
+        if (!completed) {
+            fail("Fraction(n, d)", &input, nullptr, "лишнее исключение");
+            return false;
+        }
+        if (result.getNumerator() != expectedNumerator || result.getDenominator() != expectedDenominator) {
+            fail("Fraction(n, d)", &result, nullptr, "дробь не сокращена");
+        }
+        return true;
+    }
+
+    // Все бинарные операции и сравнения для пары дробей
+    void checkBinary(const Fraction& a, const Fraction& b) {
+        Exact x = exactOf(a);
+        Exact y = exactOf(b);
+        WideInt crossA = x.numerator * y.denominator;
+        WideInt crossB = y.numerator * x.denominator;
+        WideInt product = x.denominator * y.denominator;
+
+        expect("a + b", &a, &b, makeExact(crossA + crossB, product),
+            FractionError::AdditionOverflow, [&] { return a + b; });
+        expect("a - b", &a, &b, makeExact(crossA - crossB, product),
+            FractionError::SubtractionOverflow, [&] { return a - b; });
+        expect("a * b", &a, &b, makeExact(x.numerator * y.numerator, product),
+            FractionError::MultiplicationOverflow, [&] { return a * b; });
+
+        if (y.numerator.isZero()) {
+            checkCount++;
+            Fraction result;
+            FractionError code = FractionError::Count;
+            if (run([&] { return a / b; }, result, code) || code != FractionError::DivisionByZero) {
+                fail("a / 0", &a, &b, "ожидалось DivisionByZero");
+            }
+        }
+        else {
+            expect("a / b", &a, &b, makeExact(x.numerator * y.denominator, x.denominator * y.numerator),
+                FractionError::DivisionOverflow, [&] { return a / b; });
+        }
+
+        checkCount++;
+        int order = WideInt::compare(crossA, crossB);
+        if ((a < b) != (order < 0) || (a <= b) != (order <= 0) || (a > b) != (order > 0) ||
+            (a >= b) != (order >= 0) || (a == b) != (order == 0) || (a != b) != (order != 0)) {
+            fail("сравнение", &a, &b, "порядок не совпадает с точным");
+        }
+    }
+
+    // Унарные операции и преобразования одной дроби
+    void checkUnary(const Fraction& a) {
+        Exact x = exactOf(a);
+
+        expect("-a", &a, nullptr, makeExact(-x.numerator, x.denominator),
+            FractionError::NegationOverflow, [&] { return -a; });
+
+        if (x.numerator.isZero()) {
+            checkCount++;
+            Fraction result;
+            FractionError code = FractionError::Count;
+            if (run([&] { return !a; }, result, code) || code != FractionError::ReciprocalOfZero) {
+                fail("!0", &a, nullptr, "ожидалось ReciprocalOfZero");
+            }
+        }
+        else {
+            expect("!a", &a, nullptr, makeExact(x.denominator, x.numerator),
+                FractionError::ReciprocalOverflow, [&] { return !a; });
+        }
+
+        expect("++a", &a, nullptr, makeExact(x.numerator + x.denominator, x.denominator),
+            FractionError::IncrementOverflow, [&] { Fraction copy = a; return ++copy; });
+        expect("--a", &a, nullptr, makeExact(x.numerator - x.denominator, x.denominator),
+            FractionError::DecrementOverflow, [&] { Fraction copy = a; return --copy; });
+
+        // Целая часть: int64_t отбрасывает дробную часть, uint64_t запрещен для отрицательных
+        checkCount++;
+        WideInt remainder;
+        int64_t truncated = 0;
+        x.numerator.divide(x.denominator, remainder).toInt64(truncated);
+        if (static_cast<int64_t>(a) != truncated) {
+            fail("int64_t(a)", &a, nullptr, "неверная целая часть");
+        }
+
+        checkCount++;
+        try {
+            uint64_t value = static_cast<uint64_t>(a);
+            if (a.getNumerator() < 0 || value != static_cast<uint64_t>(truncated)) {
+                fail("uint64_t(a)", &a, nullptr, "неверная целая часть");
+            }
+        }
+        catch (const FractionException& e) {
+            if (a.getNumerator() >= 0 || e.code() != FractionError::NegativeToUnsigned) {
+                fail("uint64_t(a)", &a, nullptr, "неверное исключение");
+            }
+        }
+
+        checkRounded("double(a)", a, static_cast<double>(a));
+        checkRounded("float(a)", a, static_cast<float>(a));
+    }
+
+    // Построение из double: точное значение, если оно помещается,
+    // иначе округление к сетке 2^-62 или ConversionOverflow
+    void checkFromDouble(double value) {
+        checkCount++;
+        Fraction result;
+        FractionError code = FractionError::Count;
+        bool completed = run([&] { return Fraction(value); }, result, code);
+
+        if (!std::isfinite(value)) {
+            if (completed || code != FractionError::NotANumber) {
+                fail("Fraction(double)", nullptr, nullptr, "ожидалось NotANumber");
+            }
+            return;
+        }
+        if (std::fabs(value) >= 0x1p63) {
+            // -2^63 формально помещается, но допускается и исключение
+            if (completed && !(value == -0x1p63 && result.getNumerator() == std::numeric_limits<int64_t>::min())) {
+                fail("Fraction(double)", &result, nullptr, "ожидалось ConversionOverflow");
+            }
+            else if (!completed && code != FractionError::ConversionOverflow) {
+                fail("Fraction(double)", nullptr, nullptr, "неверный код исключения");
+            }
+            return;
+        }
+        if (!completed) {
+            fail("Fraction(double)", nullptr, nullptr, "лишнее исключение");
+            return;
+        }
+
+        // value = significand * 2^exponent, знаменатель результата - степень двойки до 2^62
+        uint64_t denominator = result.getDenominator();
+        if ((denominator & (denominator - 1)) != 0 || denominator > (uint64_t{ 1 } << 62)) {
+            fail("Fraction(double)", &result, nullptr, "знаменатель не степень двойки до 2^62");
+            return;
+        }
+        if (value == 0.0) {
+            if (result.getNumerator() != 0) {
+                fail("Fraction(double)", &result, nullptr, "ноль должен дать 0/1");
+            }
+            return;
+        }
+
+        int exponent = 0;
+        double fraction = std::frexp(std::fabs(value), &exponent);
+        int64_t significand = static_cast<int64_t>(std::ldexp(fraction, 53));
+        exponent -= 53;
+        if (value < 0) {
+            significand = -significand;
+        }
+        if (exponent < -126) {
+            // |value| < 2^-73 меньше половины шага сетки 2^-62
+            if (result.getNumerator() != 0) {
+                fail("Fraction(double)", &result, nullptr, "ожидался ноль");
+            }
+            return;
+        }
+
+        // |significand * 2^exponent - n / d| <= 2^-63, в целых после умножения на 2^(63 - exponent)
+        int scale = 0;
+        for (uint64_t d = denominator; d > 1; d >>= 1) {
+            scale++;
+        }
+        WideInt exact = wide(significand);
+        WideInt approximation = wide(result.getNumerator());
+        if (exponent >= 0) {
+            exact = exact.shiftLeft(exponent + 63);
+            approximation = approximation.shiftLeft(63 - scale);
+        }
+        else {
+            exact = exact.shiftLeft(63);
+            approximation = approximation.shiftLeft(63 - scale - exponent);
+        }
+        WideInt error = (exact - approximation).abs();
+        WideInt limit = exponent >= 0 ? wide(int64_t{ 0 }) : wide(int64_t{ 1 }).shiftLeft(-exponent);
+        if (error > limit) {
+            fail("Fraction(double)", &result, nullptr, "значение не совпадает с double");
+        }
+        // Если значение представимо точно, ошибки быть не должно
+        if (exponent >= -62 && !error.isZero()) {
+            fail("Fraction(double)", &result, nullptr, "точное значение округлено");
+        }
+    }
+};
+
+#endif
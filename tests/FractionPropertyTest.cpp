@@ -0,0 +1,112 @@
+﻿// Свойство-тест Fraction: все операции сверяются с точной 256-битной арифметикой.
+// Сначала перебираются все пары граничных значений, затем случайные пары.
+// Аргумент: число случайных пар (по умолчанию 2000000).
+
+#include "FractionOracle.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+    const int64_t int64Max = std::numeric_limits<int64_t>::max();
+    const int64_t int64Min = std::numeric_limits<int64_t>::min();
+
+    const int64_t edgeNumerators[] = {
+        0, 1, -1, 2, -2, 3, -3, 7, -10,
+        int64Max, int64Min, int64Max - 1, int64Min + 1, int64Max / 2, int64Min / 2,
+        (int64_t{ 1 } << 32) - 1, int64_t{ 1 } << 32, (int64_t{ 1 } << 32) + 1, -(int64_t{ 1 } << 32),
+        (int64_t{ 1 } << 53) - 1, int64_t{ 1 } << 53, (int64_t{ 1 } << 53) + 1, -((int64_t{ 1 } << 53) + 1),
+        (int64_t{ 1 } << 53) - 1 - (int64_t{ 1 } << 28),     // float(n / (2^53 - 1)) округлялось дважды
+        int64_t{ 1 } << 62, -(int64_t{ 1 } << 62), (int64_t{ 1 } << 62) + 1,
+        1000000007, 3037000499, 4294967311,
+    };
+
+    const uint64_t edgeDenominators[] = {
+        0, 1, 2, 3, 7, 10, 1000000007,
+        (uint64_t{ 1 } << 32) - 1, uint64_t{ 1 } << 32, (uint64_t{ 1 } << 32) + 1,
+        (uint64_t{ 1 } << 53) - 1, (uint64_t{ 1 } << 53) + 1, uint64_t{ 1 } << 62,
+        static_cast<uint64_t>(int64Max) - 1, static_cast<uint64_t>(int64Max),
+        uint64_t{ 1 } << 63, (uint64_t{ 1 } << 63) + 2, std::numeric_limits<uint64_t>::max(),
+    };
+
+    // Случайное значение: граничное, полное, малое или с случайной длиной в битах
+    int64_t randomValue(std::mt19937_64& random) {
+        switch (random() % 4) {
+        case 0:
+            return edgeNumerators[random() % std::size(edgeNumerators)];
+        case 1:
+            return static_cast<int64_t>(random());
+        case 2:
+            return static_cast<int64_t>(random() % 2001) - 1000;
+        default: {
+            int64_t value = static_cast<int64_t>(random() >> (1 + random() % 63));
+            return random() % 2 == 0 ? value : -value;
+        }
+        }
+    }
+
+    uint64_t randomDenominator(std::mt19937_64& random) {
+        if (random() % 8 == 0) {
+            return edgeDenominators[random() % std::size(edgeDenominators)];
+        }
+        int64_t value = randomValue(random);
+        return value == int64Min ? static_cast<uint64_t>(int64Max) : static_cast<uint64_t>(value < 0 ? -value : value);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long long randomPairs = argc > 1 ? std::atoll(argv[1]) : 2000000;
+    FractionOracle oracle;
+
+    // Граничные дроби: все сочетания числителей и знаменателей
+    std::vector<Fraction> edges;
+    for (int64_t numerator : edgeNumerators) {
+        for (uint64_t denominator : edgeDenominators) {
+            Fraction value;
+            if (oracle.checkConstruction(numerator, denominator, value)) {
+                edges.push_back(value);
+            }
+        }
+    }
+    for (const Fraction& a : edges) {
+        oracle.checkUnary(a);
+        for (const Fraction& b : edges) {
+            oracle.checkBinary(a, b);
+        }
+    }
+
+    const double edgeDoubles[] = {
+        0.0, -0.0, 0.1, -2.5, 1e-30, 0x1p-62, 0x1p-63, 0x1.8p-63, 0x1p-70, 0x1p-200,
+        0x1p62, 0x1.fffffffffffffp62, 0x1p63, -0x1p63, 1e300,
+        std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::denorm_min(),
+    };
+    for (double value : edgeDoubles) {
+        oracle.checkFromDouble(value);
+    }
+
+    std::mt19937_64 random(20240601);
+    for (long long i = 0; i < randomPairs; i++) {
+        Fraction a, b;
+        bool hasA = oracle.checkConstruction(randomValue(random), randomDenominator(random), a);
+        bool hasB = oracle.checkConstruction(randomValue(random), randomDenominator(random), b);
+        if (hasA) {
+            oracle.checkUnary(a);
+        }
+        if (hasA && hasB) {
+            oracle.checkBinary(a, b);
+        }
+        uint64_t bits = random();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        oracle.checkFromDouble(value);
+    }
+
+    std::printf("Проверок: %llu, ошибок: %llu\n",
+        static_cast<unsigned long long>(oracle.checks()),
+        static_cast<unsigned long long>(oracle.failures()));
+    return oracle.failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,211 @@
+﻿// Тест FractionStatistics: сумма и среднее остаются точными, когда сумма
+// квадратов отклонений переполняется, и наоборот; приближенная дисперсия
+// сверяется с точной, посчитанной на WideInt. Квантили QuantileSketch
+// сверяются по рангу с отсортированным потоком, в том числе после merge.
+
+#include "FractionStatistics.h"
+#include "WideInt.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+    uint64_t checkCount = 0;
+    uint64_t failureCount = 0;
+
+    void expect(bool condition, const char* check) {
+        checkCount++;
+        if (!condition) {
+            failureCount++;
+            std::fprintf(stderr, "FAIL %s\n", check);
+        }
+    }
+
+    template<typename Operation>
+    bool throwsCode(Operation operation, FractionError code) {
+        try {
+            operation();
+        }
+        catch (const FractionException& e) {
+            return e.code() == code;
+        }
+        return false;
+    }
+
+    double relativeError(double value, double reference) {
+        return std::fabs(value - reference) / std::fabs(reference);
+    }
+
+    // Расстояние от q * n до диапазона рангов value в отсортированном потоке, в долях n
+    double rankError(const std::vector<double>& sorted, double value, double q) {
+        double lower = static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+        double upper = static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+        double target = q * static_cast<double>(sorted.size());
+        double distance = target < lower ? lower - target : (target > upper ? target - upper : 0.0);
+        return distance / static_cast<double>(sorted.size());
+    }
+
+    // Эскиз целиком и объединенный из частей: ошибка ранга, размер и память.
+    // Для вместимости 256 и миллиона значений ошибка ранга не больше 1%
+    // (на этих данных наблюдается до 0.25%), а хранится не больше
+    // capacity * (log2(n / capacity) + 2) элементов
+    void checkSketch(const std::vector<double>& values, const char* name) {
+        const std::size_t capacity = 256;
+        const double maxRankError = 0.01;
+        const int partCount = 4;
+
+        QuantileSketch whole(capacity);
+        std::vector<QuantileSketch> parts(partCount, QuantileSketch(capacity));
+        bool bounded = true;
+        for (std::size_t i = 0; i < values.size(); i++) {
+            whole.add(values[i]);
+            parts[i % partCount].add(values[i]);
+            if (i % 4096 == 0) {
+                std::size_t levels = std::bit_width(whole.size() / capacity) + 2;
+                bounded &= whole.retained() <= capacity * levels;
+            }
+        }
+        QuantileSketch merged(capacity);
+        for (const QuantileSketch& part : parts) {
+            merged.merge(part);
+        }
+
+        std::vector<double> sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+        std::size_t levels = std::bit_width(values.size() / capacity) + 2;
+        for (const QuantileSketch* sketch : { &whole, &merged }) {
+            const char* kind = sketch == &whole ? "целый" : "объединенный";
+            double worst = 0.0;
+            for (double q : { 0.01, 0.5, 0.99 }) {
+                worst = std::max(worst, rankError(sorted, sketch->quantile(q), q));
+            }
+            if (worst >= maxRankError) {
+                std::fprintf(stderr, "%s, %s эскиз: ошибка ранга %.4f\n", name, kind, worst);
+            }
+            expect(worst < maxRankError, "ошибка ранга квантиля");
+            expect(sketch->size() == values.size(), "size() эскиза");
+            expect(sketch->retained() <= capacity * levels, "retained() эскиза ограничен");
+        }
+        expect(bounded, "retained() ограничен по ходу потока");
+    }
+
+    // Значения со знаменателями 1..4: в двенадцатых долях это целые числа
+    Fraction streamValue(uint64_t i) {
+        return Fraction(static_cast<int64_t>(i * 7919 % 100003) - 50000, i % 4 + 1);
+    }
+
+    int64_t twelfths(uint64_t i) {
+        return (static_cast<int64_t>(i * 7919 % 100003) - 50000) * static_cast<int64_t>(12 / (i % 4 + 1));
+    }
+}
+
+int main() {
+    const uint64_t streamLength = 1000000;
+    const int partCount = 4;
+
+    FractionStatistics whole;
+    std::vector<FractionStatistics> parts(partCount);
+    WideInt sumTwelfths, sumSquares;
+    for (uint64_t i = 0; i < streamLength; i++) {
+        whole += streamValue(i);
+        parts[i % partCount] += streamValue(i);
+        WideInt value = WideInt::fromInt64(twelfths(i));
+        sumTwelfths = sumTwelfths + value;
+        sumSquares = sumSquares + value * value;
+    }
+    FractionStatistics merged;
+    for (const FractionStatistics& part : parts) {
+        merged.merge(part);
+    }
+
+    // Точная сумма в двенадцатых долях
+    int64_t expectedTwelfths = 0;
+    sumTwelfths.toInt64(expectedTwelfths);
+    Fraction expectedSum(expectedTwelfths, 12);
+    Fraction expectedMean = expectedSum / static_cast<int64_t>(streamLength);
+
+    // Дисперсия = (n * sum(a^2) - (sum a)^2) / (144 * n^2)
+    WideInt count = WideInt::fromUInt64(streamLength);
+    double expectedVariance = (count * sumSquares - sumTwelfths * sumTwelfths).toDouble() /
+        (144.0 * static_cast<double>(streamLength) * static_cast<double>(streamLength));
+
+    for (const FractionStatistics* statistics : { &whole, &merged }) {
+        expect(statistics->count() == streamLength, "count");
+        expect(statistics->isSumExact(), "сумма должна остаться точной");
+        expect(!statistics->isVarianceExact(), "сумма квадратов должна переполниться в этом потоке");
+        expect(statistics->sum() == expectedSum, "точная сумма");
+        expect(statistics->mean() == expectedMean, "точное среднее total / n");
+        expect(throwsCode([&] { statistics->variance(); }, FractionError::PrecisionLost), "variance() без точности");
+        expect(relativeError(statistics->varianceApprox(), expectedVariance) < 1e-15, "приближенная дисперсия");
+        expect(relativeError(statistics->meanApprox(), static_cast<double>(expectedMean)) < 1e-15, "приближенное среднее");
+    }
+
+    // Переполняется сумма, а дисперсия одинаковых значений остается точной
+    FractionStatistics large;
+    const int64_t big = std::numeric_limits<int64_t>::max() / 2;
+    for (int i = 0; i < 3; i++) {
+        large += Fraction(big);
+    }
+    expect(!large.isSumExact() && large.isVarianceExact(), "переполнение только суммы");
+    expect(throwsCode([&] { large.sum(); }, FractionError::PrecisionLost), "sum() без точности");
+    expect(large.mean() == Fraction(big), "среднее из шага Уэлфорда");
+    expect(large.variance() == Fraction(0), "точная нулевая дисперсия");
+    expect(relativeError(large.sumApprox(), 3.0 * static_cast<double>(big)) < 1e-15, "приближенная сумма");
+
+    // Малый поток считается точно целиком
+    FractionStatistics small;
+    for (int i = 1; i <= 10; i++) {
+        small += Fraction(i, static_cast<uint64_t>(i % 3 + 1));
+    }
+    expect(small.isExact(), "малый поток точен");
+    expect(small.sum() == Fraction(34) && small.mean() == Fraction(17, 5), "сумма и среднее малого потока");
+    expect(small.variance() == Fraction(1867, 300), "дисперсия малого потока");
+
+    // Объединение с самим собой: поток из двух копий
+    FractionStatistics doubled = small;
+    doubled.merge(doubled);
+    expect(doubled.count() == 20 && doubled.sum() == Fraction(68), "объединение с собой: сумма");
+    expect(doubled.variance() == Fraction(1867, 300), "объединение с собой: дисперсия не меняется");
+    expect(doubled.quantiles().size() == 20, "объединение с собой: эскиз");
+
+    FractionStatistics empty;
+    expect(throwsCode([&] { empty.mean(); }, FractionError::EmptyStatistics), "среднее пустого потока");
+
+    // Квантили: непрерывные значения, значения с большим числом повторов и
+    // возрастающий поток (уровни эскиза хранят разные диапазоны значений)
+    std::mt19937_64 random(2718);
+    std::vector<double> continuous(streamLength);
+    std::vector<double> repeated(streamLength);
+    std::vector<double> ascending(streamLength);
+    for (uint64_t i = 0; i < streamLength; i++) {
+        continuous[i] = std::ldexp(static_cast<double>(random() >> 11), -53);
+        repeated[i] = static_cast<double>(random() % 1000);
+        ascending[i] = static_cast<double>(i);
+    }
+    checkSketch(continuous, "непрерывные значения");
+    checkSketch(repeated, "повторяющиеся значения");
+    checkSketch(ascending, "возрастающий поток");
+
+    // Квантиль из FractionStatistics - по тому же потоку дробей
+    std::vector<double> streamDoubles(streamLength);
+    for (uint64_t i = 0; i < streamLength; i++) {
+        streamDoubles[i] = static_cast<double>(streamValue(i));
+    }
+    std::sort(streamDoubles.begin(), streamDoubles.end());
+    expect(rankError(streamDoubles, whole.quantile(0.5), 0.5) < 0.01, "медиана потока дробей");
+    expect(rankError(streamDoubles, merged.quantile(0.5), 0.5) < 0.01, "медиана объединенной статистики");
+
+    QuantileSketch emptySketch;
+    expect(throwsCode([&] { emptySketch.quantile(0.5); }, FractionError::EmptySketch), "квантиль пустого эскиза");
+    expect(throwsCode([&] { whole.quantile(1.5); }, FractionError::QuantileOutOfRange), "уровень больше 1");
+    expect(throwsCode([&] { whole.quantile(std::nan("")); }, FractionError::QuantileOutOfRange), "уровень NaN");
+
+    std::printf("Проверок: %llu, ошибок: %llu\n",
+        static_cast<unsigned long long>(checkCount), static_cast<unsigned long long>(failureCount));
+    return failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,292 @@
+﻿#ifndef WIDE_INT_H
+#define WIDE_INT_H
+
+// Эталонная целочисленная арифметика для проверки Fraction.
+// Знак + модуль из 8 слов по 32 бита (256 бит), реализация намеренно
+// простая и не зависит от 128-битных помощников библиотеки.
+
+#include <cstdint>
+#include <cstdlib>
+
+class WideInt {
+public:
+    static constexpr int limbCount = 8;
+
+private:
+    bool negative;
+    uint32_t limbs[limbCount];      // Младшее слово первым
+
+    static int compareMagnitude(const WideInt& a, const WideInt& b) {
+        for (int i = limbCount - 1; i >= 0; i--) {
+            if (a.limbs[i] != b.limbs[i]) {
+                return a.limbs[i] < b.limbs[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static WideInt addMagnitude(const WideInt& a, const WideInt& b) {
+        WideInt result;
+        uint64_t carry = 0;
+        for (int i = 0; i < limbCount; i++) {
+            uint64_t sum = uint64_t{ a.limbs[i] } + b.limbs[i] + carry;
+            result.limbs[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        if (carry != 0) {
+            std::abort();   // Выход за 256 бит: ошибка в самом тесте
+        }
+        return result;
+    }
+
+    // |a| - |b|, требуется |a| >= |b|
+    static WideInt subtractMagnitude(const WideInt& a, const WideInt& b) {
+        WideInt result;
+        int64_t borrow = 0;
+        for (int i = 0; i < limbCount; i++) {
+            int64_t difference = int64_t{ a.limbs[i] } - b.limbs[i] - borrow;
+            borrow = difference < 0 ? 1 : 0;
+            result.limbs[i] = static_cast<uint32_t>(difference + (borrow << 32));
+        }
+        return result;
+    }
+
+    void fixZeroSign() {
+        if (isZero()) {
+            negative = false;
+        }
+    }
+
+public:
+    WideInt() : negative(false), limbs{} {}
+
+    static WideInt fromUInt64(uint64_t value) {
+        WideInt result;
+        result.limbs[0] = static_cast<uint32_t>(value);
+        result.limbs[1] = static_cast<uint32_t>(value >> 32);
+        return result;
+    }
+
+    static WideInt fromInt64(int64_t value) {
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        WideInt result = fromUInt64(magnitude);
+        result.negative = value < 0;
+        return result;
+    }
+
+    bool isZero() const {
+        for (uint32_t limb : limbs) {
+            if (limb != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isNegative() const { return negative; }
+    bool isOdd() const { return (limbs[0] & 1) != 0; }
+
+    WideInt abs() const {
+        WideInt result = *this;
+        result.negative = false;
+        return result;
+    }
+
+    WideInt operator-() const {
+        WideInt result = *this;
+        result.negative = !negative;
+        result.fixZeroSign();
+        return result;
+    }
+
+    WideInt operator+(const WideInt& other) const {
+        WideInt result;
+        if (negative == other.negative) {
+            result = addMagnitude(*this, other);
+            result.negative = negative;
+        }
+        else if (compareMagnitude(*this, other) >= 0) {
+            result = subtractMagnitude(*this, other);
+            result.negative = negative;
+        }
+        else {
+            result = subtractMagnitude(other, *this);
+            result.negative = other.negative;
+        }
+        result.fixZeroSign();
+        return result;
+    }
+
+    WideInt operator-(const WideInt& other) const {
+        return *this + (-other);
+    }
+
+    WideInt operator*(const WideInt& other) const {
+        uint32_t product[2 * limbCount] = {};
+        for (int i = 0; i < limbCount; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; j < limbCount; j++) {
+                uint64_t current = uint64_t{ limbs[i] } * other.limbs[j] + product[i + j] + carry;
+                product[i + j] = static_cast<uint32_t>(current);
+                carry = current >> 32;
+            }
+            product[i + limbCount] = static_cast<uint32_t>(carry);
+        }
+        WideInt result;
+        for (int i = 0; i < limbCount; i++) {
+            result.limbs[i] = product[i];
+            if (product[i + limbCount] != 0) {
+                std::abort();
+            }
+        }
+        result.negative = negative != other.negative;
+        result.fixZeroSign();
+        return result;
+    }
+
+    // Умножение на 2^bits (bits >= 0)
+    WideInt shiftLeft(int bits) const {
+        if (!isZero() && bitLength() + bits > 32 * limbCount) {
+            std::abort();
+        }
+        WideInt result;
+        int words = bits / 32, rest = bits % 32;
+        for (int i = limbCount - 1; i >= words; i--) {
+            uint64_t value = uint64_t{ limbs[i - words] } << rest;
+            if (rest != 0 && i - words - 1 >= 0) {
+                value |= limbs[i - words - 1] >> (32 - rest);
+            }
+            result.limbs[i] = static_cast<uint32_t>(value);
+        }
+        result.negative = negative;
+        result.fixZeroSign();
+        return result;
+    }
+
+    WideInt shiftRightOne() const {
+        WideInt result = *this;
+        for (int i = 0; i < limbCount; i++) {
+            result.limbs[i] = (limbs[i] >> 1) | (i + 1 < limbCount ? limbs[i + 1] << 31 : 0);
+        }
+        result.fixZeroSign();
+        return result;
+    }
+
+    int bitLength() const {
+        for (int i = limbCount - 1; i >= 0; i--) {
+            if (limbs[i] != 0) {
+                int bits = 0;
+                for (uint32_t limb = limbs[i]; limb != 0; limb >>= 1) {
+                    bits++;
+                }
+                return i * 32 + bits;
+            }
+        }
+        return 0;
+    }
+
+    bool testBit(int bit) const {
+        return ((limbs[bit / 32] >> (bit % 32)) & 1) != 0;
+    }
+
+    // Деление модулей с остатком (двоичное деление столбиком), знак частного по правилам C++
+    WideInt divide(const WideInt& divisor, WideInt& remainder) const {
+        if (divisor.isZero()) {
+            std::abort();
+        }
+        WideInt quotient;
+        WideInt current;
+        WideInt divisorMagnitude = divisor.abs();
+        for (int bit = bitLength() - 1; bit >= 0; bit--) {
+            current = current.shiftLeft(1);
+            if (testBit(bit)) {
+                current.limbs[0] |= 1;
+            }
+            if (compareMagnitude(current, divisorMagnitude) >= 0) {
+                current = subtractMagnitude(current, divisorMagnitude);
+                quotient.limbs[bit / 32] |= uint32_t{ 1 } << (bit % 32);
+            }
+        }
+        quotient.negative = negative != divisor.negative;
+        quotient.fixZeroSign();
+        remainder = current;
+        remainder.negative = negative;
+        remainder.fixZeroSign();
+        return quotient;
+    }
+
+    // НОД модулей (двоичный алгоритм Стейна)
+    static WideInt gcd(WideInt a, WideInt b) {
+        a = a.abs();
+        b = b.abs();
+        if (a.isZero()) {
+            return b;
+        }
+        if (b.isZero()) {
+            return a;
+        }
+        int shift = 0;
+        while (!a.isOdd() && !b.isOdd()) {
+            a = a.shiftRightOne();
+            b = b.shiftRightOne();
+            shift++;
+        }
+        while (!a.isOdd()) {
+            a = a.shiftRightOne();
+        }
+        while (!b.isZero()) {
+            while (!b.isOdd()) {
+                b = b.shiftRightOne();
+            }
+            if (compareMagnitude(a, b) > 0) {
+                WideInt temp = a;
+                a = b;
+                b = temp;
+            }
+            b = subtractMagnitude(b, a);
+        }
+        return a.shiftLeft(shift);
+    }
+
+    static int compare(const WideInt& a, const WideInt& b) {
+        if (a.negative != b.negative) {
+            return a.negative ? -1 : 1;
+        }
+        int order = compareMagnitude(a, b);
+        return a.negative ? -order : order;
+    }
+
+    bool operator==(const WideInt& other) const { return compare(*this, other) == 0; }
+    bool operator!=(const WideInt& other) const { return compare(*this, other) != 0; }
+    bool operator<(const WideInt& other) const { return compare(*this, other) < 0; }
+    bool operator<=(const WideInt& other) const { return compare(*this, other) <= 0; }
+    bool operator>(const WideInt& other) const { return compare(*this, other) > 0; }
+    bool operator>=(const WideInt& other) const { return compare(*this, other) >= 0; }
+
+    // Приближенное значение (ошибка порядка единицы младшего разряда double)
+    double toDouble() const {
+        double result = 0.0;
+        for (int i = limbCount - 1; i >= 0; i--) {
+            result = result * 4294967296.0 + limbs[i];
+        }
+        return negative ? -result : result;
+    }
+
+    // Значение в int64_t, false если не помещается
+    bool toInt64(int64_t& value) const {
+        for (int i = 2; i < limbCount; i++) {
+            if (limbs[i] != 0) {
+                return false;
+            }
+        }
+        uint64_t magnitude = (uint64_t{ limbs[1] } << 32) | limbs[0];
+        uint64_t limit = uint64_t{ 1 } << 63;
+        if (negative ? magnitude > limit : magnitude >= limit) {
+            return false;
+        }
+        value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+        return true;
+    }
+};
+
+#endif
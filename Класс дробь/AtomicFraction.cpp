@@ -0,0 +1,260 @@
+﻿#include "AtomicFraction.h"
+#include <atomic>
+#include <bit>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+AtomicFraction::Raw AtomicFraction::toRaw(const Fraction& frac) {
+    return Raw{ frac.numerator, frac.denominator };
+}
+
+Fraction AtomicFraction::fromRaw(const Raw& raw) {
+    // Хранимое значение уже в канонической форме, нормализация не нужна
+    Fraction result;
+    result.numerator = raw.numerator;
+    result.denominator = raw.denominator;
+    return result;
+}
+
+#if FRACTION_HAS_CAS128
+
+bool AtomicFraction::compareExchangeRaw(Raw& expected, const Raw& desired) {
+#if defined(_MSC_VER)
+    return _InterlockedCompareExchange128(
+        reinterpret_cast<volatile long long*>(&value),
+        static_cast<long long>(desired.denominator),
+        static_cast<long long>(desired.numerator),
+        reinterpret_cast<long long*>(&expected)) != 0;
+#else
+    unsigned __int128 cmp, xchg;
+    __builtin_memcpy(&cmp, &expected, sizeof(cmp));
+    __builtin_memcpy(&xchg, &desired, sizeof(xchg));
+    unsigned __int128 prev = __sync_val_compare_and_swap(
+        reinterpret_cast<unsigned __int128*>(&value), cmp, xchg);
+    if (prev == cmp) {
+        return true;
+    }
+    __builtin_memcpy(&expected, &prev, sizeof(prev));
+    return false;
+#endif
+}
+
+AtomicFraction::Raw AtomicFraction::loadRaw() const {
+    // Атомарное чтение 16 байт возможно только через CAS.
+    // Знаменатель никогда не равен нулю, поэтому запись 0/0 не произойдет.
+    Raw result{ 0, 0 };
+    const_cast<AtomicFraction*>(this)->compareExchangeRaw(result, result);
+    return result;
+}
+
+AtomicFraction::Raw AtomicFraction::peekRaw() const {
+    // Два отдельных 64-битных чтения: разорванная пара просто не пройдет первый CAS
+    return Raw{
+        std::atomic_ref<int64_t>(value.numerator).load(std::memory_order_relaxed),
+        std::atomic_ref<uint64_t>(value.denominator).load(std::memory_order_relaxed) };
+}
+
+#else
+
+bool AtomicFraction::compareExchangeRaw(Raw& expected, const Raw& desired) {
+    std::lock_guard<std::mutex> lock(guard);
+    if (value.numerator == expected.numerator && value.denominator == expected.denominator) {
+        value = desired;
+        return true;
+    }
+    expected = value;
+    return false;
+}
+
+AtomicFraction::Raw AtomicFraction::loadRaw() const {
+    std::lock_guard<std::mutex> lock(guard);
+    return value;
+}
+
+AtomicFraction::Raw AtomicFraction::peekRaw() const {
+    return loadRaw();
+}
+
+#endif
+
+template<typename Op>
+Fraction AtomicFraction::update(Op op) {
+    Raw expected = peekRaw();
+    bool consistent = !FRACTION_HAS_CAS128;     // Значение получено атомарно
+    for (;;) {
+        Fraction current = fromRaw(expected);
+        Raw desired;
+        try {
+            desired = toRaw(op(current));
+        }
+        catch (const FractionException&) {
+            // Ошибка на разорванной паре не считается: перечитываем атомарно
+            if (consistent) {
+                throw;
+            }
+            expected = loadRaw();
+            consistent = true;
+            continue;
+        }
+        if (compareExchangeRaw(expected, desired)) {
+            return current;
+        }
+        consistent = true;      // Неудачный CAS возвращает текущее значение
+    }
+}
+
+AtomicFraction::AtomicFraction() : value{ 0, 1 } {}
+
+AtomicFraction::AtomicFraction(const Fraction& initial) : value(toRaw(initial)) {}
+
+Fraction AtomicFraction::load() const {
+    return fromRaw(loadRaw());
+}
+
+void AtomicFraction::store(const Fraction& frac) {
+    exchange(frac);
+}
+
+Fraction AtomicFraction::exchange(const Fraction& frac) {
+    return update([&frac](const Fraction&) { return frac; });
+}
+
+bool AtomicFraction::compareExchange(Fraction& expected, const Fraction& desired) {
+    Raw raw = toRaw(expected);
+    if (compareExchangeRaw(raw, toRaw(desired))) {
+        return true;
+    }
+    expected = fromRaw(raw);
+    return false;
+}
+
+Fraction AtomicFraction::fetchAdd(const Fraction& delta) {
+    return update([&delta](const Fraction& current) { return current + delta; });
+}
+
+Fraction AtomicFraction::fetchSub(const Fraction& delta) {
+    return update([&delta](const Fraction& current) { return current - delta; });
+}
+
+Fraction AtomicFraction::fetchMul(const Fraction& factor) {
+    return update([&factor](const Fraction& current) { return current * factor; });
+}
+
+Fraction AtomicFraction::fetchDiv(const Fraction& divisor) {
+    return update([&divisor](const Fraction& current) { return current / divisor; });
+}
+
+Fraction AtomicFraction::operator+=(const Fraction& delta) {
+    return fetchAdd(delta) + delta;
+}
+
+Fraction AtomicFraction::operator-=(const Fraction& delta) {
+    return fetchSub(delta) - delta;
+}
+
+Fraction AtomicFraction::operator*=(const Fraction& factor) {
+    return fetchMul(factor) * factor;
+}
+
+Fraction AtomicFraction::operator/=(const Fraction& divisor) {
+    return fetchDiv(divisor) / divisor;
+}
+
+namespace {
+    static_assert(ConcurrentFractionSum::shardCount == 64, "Занятые шарды хранятся в 64-битной маске");
+
+    std::atomic<uint64_t> claimedShards{ 0 };
+
+    // Шард, закрепленный за потоком на время его жизни
+    struct ShardLease {
+        std::size_t index = ConcurrentFractionSum::shardCount;
+
+        ShardLease() {
+            uint64_t claimed = claimedShards.load(std::memory_order_relaxed);
+            while (claimed != ~uint64_t{ 0 }) {
+                std::size_t free = static_cast<std::size_t>(std::countr_one(claimed));
+                if (claimedShards.compare_exchange_weak(claimed, claimed | (uint64_t{ 1 } << free),
+                    std::memory_order_acquire, std::memory_order_relaxed)) {
+                    index = free;
+                    break;
+                }
+            }
+        }
+
+        ~ShardLease() {
+            if (index < ConcurrentFractionSum::shardCount) {
+                claimedShards.fetch_and(~(uint64_t{ 1 } << index), std::memory_order_release);
+            }
+        }
+    };
+}
+
+std::size_t ConcurrentFractionSum::shardIndex() {
+    thread_local const ShardLease lease;
+    return lease.index;
+}
+
+bool ConcurrentFractionSum::hasOwnShard() {
+    return shardIndex() != shardCount;
+}
+
+Fraction ConcurrentFractionSum::readShard(const Shard& shard) {
+    Fraction result;
+    for (;;) {
+        uint64_t before = shard.version.load(std::memory_order_acquire);
+        int64_t numerator = shard.numerator.load(std::memory_order_relaxed);
+        uint64_t denominator = shard.denominator.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((before & 1) == 0 && shard.version.load(std::memory_order_relaxed) == before) {
+            result.numerator = numerator;
+            result.denominator = denominator;
+            return result;
+        }
+    }
+}
+
+void ConcurrentFractionSum::writeShard(Shard& shard, const Fraction& value) {
+    uint64_t version = shard.version.load(std::memory_order_relaxed);
+    shard.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    shard.numerator.store(value.numerator, std::memory_order_relaxed);
+    shard.denominator.store(value.denominator, std::memory_order_relaxed);
+    shard.version.store(version + 2, std::memory_order_release);
+}
+
+void ConcurrentFractionSum::add(const Fraction& value) {
+    std::size_t index = shardIndex();
+    if (index == shardCount) {
+        overflow.fetchAdd(value);
+        return;
+    }
+
+    // Писатель шарда единственный, поэтому собственное значение читается без seqlock
+    Shard& shard = shards[index];
+    Fraction current;
+    current.numerator = shard.numerator.load(std::memory_order_relaxed);
+    current.denominator = shard.denominator.load(std::memory_order_relaxed);
+    writeShard(shard, current + value);     // Исключение оставляет шард без изменений
+}
+
+ConcurrentFractionSum& ConcurrentFractionSum::operator+=(const Fraction& value) {
+    add(value);
+    return *this;
+}
+
+Fraction ConcurrentFractionSum::sum() const {
+    Fraction total = overflow.load();
+    for (const Shard& shard : shards) {
+        total += readShard(shard);
+    }
+    return total;
+}
+
+void ConcurrentFractionSum::reset() {
+    for (Shard& shard : shards) {
+        writeShard(shard, Fraction());
+    }
+    overflow.store(Fraction());
+}
@@ -0,0 +1,107 @@
+﻿#ifndef ATOMIC_FRACTION_H
+#define ATOMIC_FRACTION_H
+
+#include "Fraction.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Наличие 128-битного сравнения с обменом (cmpxchg16b)
+#if defined(_MSC_VER) && defined(_M_X64)
+#define FRACTION_HAS_CAS128 1
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define FRACTION_HAS_CAS128 1
+#else
+#define FRACTION_HAS_CAS128 0
+#endif
+
+// Дробь с атомарными операциями. Числитель и знаменатель обновляются
+// одним 128-битным CAS; без cmpxchg16b используется мьютекс.
+class AtomicFraction {
+private:
+    struct alignas(16) Raw {
+        int64_t numerator;
+        uint64_t denominator;
+    };
+
+    mutable Raw value;
+#if !FRACTION_HAS_CAS128
+    mutable std::mutex guard;
+#endif
+
+    Raw loadRaw() const;
+    Raw peekRaw() const;            // Начальное значение для CAS, может быть несогласованным
+    bool compareExchangeRaw(Raw& expected, const Raw& desired);
+
+    static Raw toRaw(const Fraction& frac);
+    static Fraction fromRaw(const Raw& raw);
+
+    // Цикл CAS: op вычисляет новое значение, исключение op оставляет значение без изменений
+    template<typename Op>
+    Fraction update(Op op);
+
+public:
+    AtomicFraction();                                   // 0/1
+    explicit AtomicFraction(const Fraction& initial);
+    AtomicFraction(const AtomicFraction&) = delete;
+    AtomicFraction& operator=(const AtomicFraction&) = delete;
+
+    static constexpr bool isLockFree() { return FRACTION_HAS_CAS128 != 0; }
+
+    Fraction load() const;
+    void store(const Fraction& frac);
+    Fraction exchange(const Fraction& frac);
+    bool compareExchange(Fraction& expected, const Fraction& desired);
+
+    // Возвращают предыдущее значение
+    Fraction fetchAdd(const Fraction& delta);
+    Fraction fetchSub(const Fraction& delta);
+    Fraction fetchMul(const Fraction& factor);
+    Fraction fetchDiv(const Fraction& divisor);
+
+    // Возвращают новое значение
+    Fraction operator+=(const Fraction& delta);
+    Fraction operator-=(const Fraction& delta);
+    Fraction operator*=(const Fraction& factor);
+    Fraction operator/=(const Fraction& divisor);
+};
+
+// Сумма дробей, разбитая на шарды по потокам. Пока живых потоков не больше
+// shardCount, каждый пишет в свой шард без CAS; шарды объединяются только при чтении.
+class ConcurrentFractionSum {
+public:
+    static constexpr std::size_t shardCount = 64;
+
+private:
+    // Шард с единственным писателем: согласованность чтения обеспечивает
+    // счетчик версий (seqlock), нечетная версия означает незавершенную запись
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> version{ 0 };
+        std::atomic<int64_t> numerator{ 0 };
+        std::atomic<uint64_t> denominator{ 1 };
+    };
+
+    Shard shards[shardCount];
+    AtomicFraction overflow;            // Для потоков, которым не хватило шарда
+
+    static std::size_t shardIndex();    // Шард текущего потока или shardCount
+    static Fraction readShard(const Shard& shard);
+    static void writeShard(Shard& shard, const Fraction& value);
+
+public:
+    ConcurrentFractionSum() = default;
+    ConcurrentFractionSum(const ConcurrentFractionSum&) = delete;
+    ConcurrentFractionSum& operator=(const ConcurrentFractionSum&) = delete;
+
+    void add(const Fraction& value);
+    ConcurrentFractionSum& operator+=(const Fraction& value);
+
+    Fraction sum() const;   // Объединение шардов
+    void reset();           // Не потокобезопасно относительно add()
+
+    // Закреплен ли за текущим потоком шард; иначе add() идет через общий CAS
+    static bool hasOwnShard();
+};
+
+#endif
@@ -1,48 +1,139 @@
 ﻿#include "Fraction.h"
+#include "FractionWide.h"
 #include <sstream>
 #include <cmath>
 #include <limits>
 #include <cstdlib> 
 #include <cstdint> 
+#include <cstdio>
+#include <cinttypes>
+#include <atomic>
+
+namespace {
+    // Таблицы сообщений, порядок совпадает с FractionError
+    const char* const russianMessages[] = {
+        "Знаменатель не может быть нулем",
+        "Переполнение при сложении дробей",
+        "Переполнение при вычитании дробей",
+        "Переполнение при умножении дробей",
+        "Деление на ноль",
+        "Переполнение при делении дробей",
+        "Переполнение при унарном минусе",
+        "Невозможно получить обратную дробь к нулю",
+        "Переполнение при получении обратной дроби",
+        "Переполнение при инкременте",
+        "Переполнение при декременте",
+        "Отрицательная дробь не может быть приведена к uint64_t",
+        "Квантиль пустого эскиза не определен",
+        "Уровень квантиля должен быть в диапазоне [0, 1]",
+        "Статистика пустого потока не определена",
+        "Точное значение потеряно из-за переполнения",
+        "Недостаточно значений для вычисления",
+        "Значение не помещается в дробь",
+        "NaN или бесконечность не может быть преобразовано в дробь",
+        "Размеры входного и выходного массивов не совпадают",
+        "Недопустимое число десятичных знаков",
+    };
 
-bool Fraction::willAdditionOverflow(int64_t a, int64_t b) {
-    if (b > 0) {
-        return a > std::numeric_limits<int64_t>::max() - b;
-    }
-    else {
-        return a < std::numeric_limits<int64_t>::min() - b;
+    const char* const englishMessages[] = {
+        "Denominator cannot be zero",
+        "Overflow in fraction addition",
+        "Overflow in fraction subtraction",
+        "Overflow in fraction multiplication",
+        "Division by zero",
+        "Overflow in fraction division",
+        "Overflow in unary minus",
+        "Cannot take the reciprocal of zero",
+        "Overflow when taking the reciprocal",
+        "Overflow in increment",
+        "Overflow in decrement",
+        "Negative fraction cannot be converted to uint64_t",
+        "Quantile of an empty sketch is undefined",
+        "Quantile level must be in the range [0, 1]",
+        "Statistics of an empty stream are undefined",
+        "Exact value lost due to overflow",
+        "Not enough values for the computation",
+        "Value does not fit into a fraction",
+        "NaN or infinity cannot be converted to a fraction",
+        "Input and output array sizes differ",
+        "Invalid number of decimal digits",
+    };
+
+    constexpr std::size_t messageCount = static_cast<std::size_t>(FractionError::Count);
+    static_assert(sizeof(russianMessages) / sizeof(russianMessages[0]) == messageCount,
+        "Таблица сообщений не соответствует FractionError");
+    static_assert(sizeof(englishMessages) / sizeof(englishMessages[0]) == messageCount,
+        "Таблица сообщений не соответствует FractionError");
+
+    std::atomic<FractionLanguage> currentLanguage{ FractionLanguage::Russian };
+
+    FractionOperand operandOf(const Fraction& frac) {
+        return FractionOperand{ frac.getNumerator(), frac.getDenominator() };
     }
 }
 
-bool Fraction::willMultiplicationOverflow(int64_t a, int64_t b) {
-    if (a > 0) {
-        if (b > 0) {
-            return a > std::numeric_limits<int64_t>::max() / b;
-        }
-        else {
-            return b < std::numeric_limits<int64_t>::min() / a;
-        }
+FractionException::FractionException(FractionError code) noexcept
+    : errorCode(code), operandCount(0), operandValues{} {
+    format();
+}
+
+FractionException::FractionException(FractionError code, FractionOperand lhs) noexcept
+    : errorCode(code), operandCount(1), operandValues{ lhs } {
+    format();
+}
+
+FractionException::FractionException(FractionError code, FractionOperand lhs, FractionOperand rhs) noexcept
+    : errorCode(code), operandCount(2), operandValues{ lhs, rhs } {
+    format();
+}
+
+void FractionException::format() noexcept {
+    int length = std::snprintf(text, sizeof(text), operandCount == 0 ? "%s" : "%s (", message(errorCode));
+    for (std::size_t i = 0; i < operandCount && length > 0 && static_cast<std::size_t>(length) < sizeof(text); i++) {
+        length += std::snprintf(text + length, sizeof(text) - length, "%s%" PRId64 "/%" PRIu64,
+            i == 0 ? "" : ", ", operandValues[i].numerator, operandValues[i].denominator);
     }
-    else {
-        if (b > 0) {
-            return a < std::numeric_limits<int64_t>::min() / b;
-        }
-        else {
-            return a != 0 && b < std::numeric_limits<int64_t>::max() / a;
-        }
+    if (operandCount != 0 && length > 0 && static_cast<std::size_t>(length) < sizeof(text)) {
+        std::snprintf(text + length, sizeof(text) - length, ")");
+    }
+}
+
+const char* FractionException::what() const noexcept {
+    return text;
+}
+
+const char* FractionException::message(FractionError code) noexcept {
+    return message(code, language());
+}
+
+const char* FractionException::message(FractionError code, FractionLanguage language) noexcept {
+    std::size_t index = static_cast<std::size_t>(code);
+    if (index >= messageCount) {
+        return "";
     }
+    return language == FractionLanguage::English ? englishMessages[index] : russianMessages[index];
+}
+
+void FractionException::setLanguage(FractionLanguage language) noexcept {
+    currentLanguage.store(language, std::memory_order_relaxed);
+}
+
+FractionLanguage FractionException::language() noexcept {
+    return currentLanguage.load(std::memory_order_relaxed);
 }
 
-bool Fraction::willMultiplicationOverflow(uint64_t a, uint64_t b) {
-    if (a == 0 || b == 0) return false;
-    return a > std::numeric_limits<uint64_t>::max() / b;
+bool Fraction::willAdditionOverflow(int64_t a, int64_t b) {
+    if (b > 0) {
+        return a > std::numeric_limits<int64_t>::max() - b;
+    }
+    else {
+        return a < std::numeric_limits<int64_t>::min() - b;
+    }
 }
 
-int64_t Fraction::gcd(int64_t a, int64_t b) const {
-    a = std::llabs(a);
-    b = std::llabs(b);
+uint64_t Fraction::gcd(uint64_t a, uint64_t b) {
     while (b != 0) {
-        int64_t temp = b;
+        uint64_t temp = b;
         b = a % b;
         a = temp;
     }
@@ -55,24 +146,157 @@ void Fraction::reduce() {
         return;
     }
 
-    int64_t divisor = gcd(numerator, static_cast<int64_t>(denominator));
+    uint64_t divisor = gcd(FractionWide::magnitude(numerator), denominator);
     if (divisor != 1) {
-        numerator /= divisor;
-        denominator /= static_cast<uint64_t>(divisor);
+        // divisor >= 2, поэтому модуль частного помещается в int64_t
+        int64_t magnitude = static_cast<int64_t>(FractionWide::magnitude(numerator) / divisor);
+        numerator = numerator < 0 ? -magnitude : magnitude;
+        denominator /= divisor;
+    }
+}
+
+Fraction Fraction::fromReduced(int64_t num, uint64_t den) {
+    Fraction result;
+    result.numerator = num;
+    result.denominator = den;
+    return result;
+}
+
+bool Fraction::packParts(bool negative, uint64_t numHigh, uint64_t numLow,
+                         uint64_t denHigh, uint64_t denLow, int64_t& num, uint64_t& den) {
+    constexpr uint64_t maxPositive = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    if (numHigh != 0 || numLow > maxPositive + (negative ? 1 : 0)) {
+        return false;
+    }
+    if (denHigh != 0 || denLow > maxPositive) {
+        return false;
     }
+    num = negative ? static_cast<int64_t>(0 - numLow) : static_cast<int64_t>(numLow);
+    den = denLow;
+    return true;
+}
+
+bool Fraction::addParts(int64_t a, uint64_t b, bool cNegative, uint64_t cMagnitude, uint64_t d,
+                        int64_t& num, uint64_t& den) {
+    // a/b + c/d по Кнуту (TAOCP, 4.5.1): результат получается сразу сокращенным
+    uint64_t g1 = gcd(b, d);
+    uint64_t bReduced = b / g1;
+    uint64_t dReduced = d / g1;
+
+    uint64_t leftHigh, leftLow, rightHigh, rightLow;
+    FractionWide::multiply(FractionWide::magnitude(a), dReduced, leftHigh, leftLow);
+    FractionWide::multiply(cMagnitude, bReduced, rightHigh, rightLow);
+
+    // Сумма со знаком в виде знак + 128-битный модуль (каждое слагаемое меньше 2^126)
+    bool negative = a < 0;
+    uint64_t sumHigh, sumLow;
+    if (negative == cNegative) {
+        sumLow = leftLow + rightLow;
+        sumHigh = leftHigh + rightHigh + (sumLow < leftLow ? 1 : 0);
+    }
+    else if (leftHigh > rightHigh || (leftHigh == rightHigh && leftLow >= rightLow)) {
+        sumLow = leftLow - rightLow;
+        sumHigh = leftHigh - rightHigh - (leftLow < rightLow ? 1 : 0);
+    }
+    else {
+        negative = cNegative;
+        sumLow = rightLow - leftLow;
+        sumHigh = rightHigh - leftHigh - (rightLow < leftLow ? 1 : 0);
+    }
+
+    if (sumHigh == 0 && sumLow == 0) {
+        num = 0;
+        den = 1;
+        return true;
+    }
+
+    uint64_t g2 = 1;
+    if (g1 != 1) {
+        uint64_t remainder;
+        FractionWide::divide(sumHigh % g1, sumLow, g1, remainder);
+        g2 = gcd(remainder, g1);
+    }
+    if (sumHigh >= g2) {
+        return false;   // Числитель не меньше 2^64
+    }
+
+    uint64_t remainder;
+    uint64_t quotient = FractionWide::divide(sumHigh, sumLow, g2, remainder);
+
+    uint64_t denHigh, denLow;
+    FractionWide::multiply(bReduced, d / g2, denHigh, denLow);
+    return packParts(negative, 0, quotient, denHigh, denLow, num, den);
+}
+
+bool Fraction::multiplyParts(bool aNegative, uint64_t aMagnitude, uint64_t b,
+                             bool cNegative, uint64_t cMagnitude, uint64_t d,
+                             int64_t& num, uint64_t& den) {
+    if (aMagnitude == 0 || cMagnitude == 0) {
+        num = 0;
+        den = 1;
+        return true;
+    }
+
+    // Перекрестное сокращение: (a/b) * (c/d) = (a/g1 * c/g2) / (b/g2 * d/g1)
+    uint64_t g1 = gcd(aMagnitude, d);
+    uint64_t g2 = gcd(cMagnitude, b);
+
+    uint64_t numHigh, numLow, denHigh, denLow;
+    FractionWide::multiply(aMagnitude / g1, cMagnitude / g2, numHigh, numLow);
+    FractionWide::multiply(b / g2, d / g1, denHigh, denLow);
+    return packParts(aNegative != cNegative, numHigh, numLow, denHigh, denLow, num, den);
+}
+
+Fraction Fraction::fromFloating(double value) {
+    if (!std::isfinite(value)) {
+        throw FractionException(FractionError::NotANumber);
+    }
+    if (value == 0.0) {
+        return Fraction();
+    }
+
+    // value = mantissa * 2^exponent, mantissa - целое из 53 бит
+    int exponent = 0;
+    double fraction = std::frexp(std::fabs(value), &exponent);
+    uint64_t mantissa = static_cast<uint64_t>(std::ldexp(fraction, 53));
+    exponent -= 53;
+
+    while (exponent < 0 && (mantissa & 1) == 0) {
+        mantissa >>= 1;
+        exponent++;
+    }
+
+    if (exponent >= 0) {
+        if (exponent > 62 || mantissa > (static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) >> exponent)) {
+            throw FractionException(FractionError::ConversionOverflow);
+        }
+        int64_t num = static_cast<int64_t>(mantissa << exponent);
+        return Fraction(value < 0 ? -num : num);
+    }
+
+    // Знаменатель ограничен 2^62: лишние младшие биты округляются к ближайшему
+    int shift = -exponent - 62;
+    if (shift > 0) {
+        if (shift >= 64) {
+            return Fraction();
+        }
+        uint64_t half = uint64_t{ 1 } << (shift - 1);
+        mantissa = (mantissa >> shift) + ((mantissa & ((half << 1) - 1)) >= half ? 1 : 0);
+        exponent = -62;
+    }
+
+    int64_t num = static_cast<int64_t>(mantissa);
+    return Fraction(value < 0 ? -num : num, uint64_t{ 1 } << -exponent);
 }
 
 void Fraction::normalize() {
     if (denominator == 0) {
-        throw FractionException("Знаменатель не может быть нулем");
+        throw FractionException(FractionError::ZeroDenominator, FractionOperand{ numerator, denominator });
     }
 
-    if (static_cast<int64_t>(denominator) < 0) {
-        if (numerator == std::numeric_limits<int64_t>::min()) {
-            throw FractionException("Переполнение числителя при нормализации");
-        }
-        numerator = -numerator;
-        denominator = -static_cast<int64_t>(denominator);
+    // Знаменатель хранится без знака, но должен помещаться в int64_t
+    if (denominator > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+        throw FractionException(FractionError::ConversionOverflow, FractionOperand{ numerator, denominator });
     }
 
     reduce();
@@ -118,112 +342,72 @@ Fraction& Fraction::operator=(Fraction&& other) noexcept {
 }
 
 Fraction Fraction::operator+(const Fraction& other) const {
-    if (willMultiplicationOverflow(numerator, static_cast<int64_t>(other.denominator)) ||
-        willMultiplicationOverflow(other.numerator, static_cast<int64_t>(denominator)) ||
-        willMultiplicationOverflow(denominator, other.denominator)) {
-        throw FractionException("Переполнение при сложении дробей");
-    }
-
-    int64_t num1 = numerator * static_cast<int64_t>(other.denominator);
-    int64_t num2 = other.numerator * static_cast<int64_t>(denominator);
-    uint64_t den = denominator * other.denominator;
-
-    if (willAdditionOverflow(num1, num2)) {
-        throw FractionException("Переполнение числителя при сложении");
+    int64_t num;
+    uint64_t den;
+    if (!addParts(numerator, denominator, other.numerator < 0,
+        FractionWide::magnitude(other.numerator), other.denominator, num, den)) {
+        throw FractionException(FractionError::AdditionOverflow, operandOf(*this), operandOf(other));
     }
-
-    int64_t result_num = num1 + num2;
-
-    return Fraction(result_num, den);
+    return fromReduced(num, den);
 }
 
 Fraction Fraction::operator-(const Fraction& other) const {
-    if (willMultiplicationOverflow(numerator, static_cast<int64_t>(other.denominator)) ||
-        willMultiplicationOverflow(other.numerator, static_cast<int64_t>(denominator)) ||
-        willMultiplicationOverflow(denominator, other.denominator)) {
-        throw FractionException("Переполнение при вычитании дробей");
-    }
-
-    int64_t num1 = numerator * static_cast<int64_t>(other.denominator);
-    int64_t num2 = other.numerator * static_cast<int64_t>(denominator);
-    uint64_t den = denominator * other.denominator;
-
-    if (num2 > 0 && num1 < std::numeric_limits<int64_t>::min() + num2) {
-        throw FractionException("Переполнение числителя при вычитании");
-    }
-    if (num2 < 0 && num1 > std::numeric_limits<int64_t>::max() + num2) {
-        throw FractionException("Переполнение числителя при вычитании");
+    int64_t num;
+    uint64_t den;
+    if (!addParts(numerator, denominator, other.numerator > 0,
+        FractionWide::magnitude(other.numerator), other.denominator, num, den)) {
+        throw FractionException(FractionError::SubtractionOverflow, operandOf(*this), operandOf(other));
     }
-
-    int64_t result_num = num1 - num2;
-
-    return Fraction(result_num, den);
+    return fromReduced(num, den);
 }
 
 Fraction Fraction::operator*(const Fraction& other) const {
-    if (willMultiplicationOverflow(numerator, other.numerator)) {
-        throw FractionException("Переполнение при умножении дробей");
-    }
-
-    if (willMultiplicationOverflow(denominator, other.denominator)) {
-        throw FractionException("Переполнение при умножении дробей");
+    int64_t num;
+    uint64_t den;
+    if (!multiplyParts(numerator < 0, FractionWide::magnitude(numerator), denominator,
+        other.numerator < 0, FractionWide::magnitude(other.numerator), other.denominator, num, den)) {
+        throw FractionException(FractionError::MultiplicationOverflow, operandOf(*this), operandOf(other));
     }
-
-    int64_t num = numerator * other.numerator;
-    uint64_t den = denominator * other.denominator;
-
-    return Fraction(num, den);
+    return fromReduced(num, den);
 }
 
 Fraction Fraction::operator/(const Fraction& other) const {
     if (other.numerator == 0) {
-        throw FractionException("Деление на ноль");
+        throw FractionException(FractionError::DivisionByZero, operandOf(*this), operandOf(other));
     }
 
-    if (willMultiplicationOverflow(numerator, static_cast<int64_t>(other.denominator))) {
-        throw FractionException("Переполнение при делении дробей");
-    }
-
-    if (willMultiplicationOverflow(static_cast<int64_t>(denominator), other.numerator)) {
-        throw FractionException("Переполнение при делении дробей");
-    }
-
-    int64_t num = numerator * static_cast<int64_t>(other.denominator);
-    int64_t den = static_cast<int64_t>(denominator) * other.numerator;
-
-    if (den < 0) {
-        num = -num;
-        den = -den;
-    }
-
-    if (den < 0 || static_cast<uint64_t>(den) > std::numeric_limits<uint64_t>::max()) {
-        throw FractionException("Переполнение знаменателя при делении");
+    // Умножение на обратную дробь d/c, знак c переходит в числитель
+    int64_t num;
+    uint64_t den;
+    if (!multiplyParts(numerator < 0, FractionWide::magnitude(numerator), denominator,
+        other.numerator < 0, other.denominator, FractionWide::magnitude(other.numerator), num, den)) {
+        throw FractionException(FractionError::DivisionOverflow, operandOf(*this), operandOf(other));
     }
-
-    return Fraction(num, static_cast<uint64_t>(den));
+    return fromReduced(num, den);
 }
 
 Fraction Fraction::operator-() const {
     if (numerator == std::numeric_limits<int64_t>::min()) {
-        throw FractionException("Переполнение при унарном минусе");
+        throw FractionException(FractionError::NegationOverflow, operandOf(*this));
     }
     return Fraction(-numerator, denominator);
 }
 
 Fraction Fraction::operator!() const {
     if (numerator == 0) {
-        throw FractionException("Невозможно получить обратную дробь к нулю");
+        throw FractionException(FractionError::ReciprocalOfZero);
     }
     if (numerator > 0) {
         if (denominator > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
-            throw FractionException("Переполнение при получении обратной дроби");
+            throw FractionException(FractionError::ReciprocalOverflow, operandOf(*this));
         }
         return Fraction(static_cast<int64_t>(denominator), static_cast<uint64_t>(numerator));
     }
     else {
-        uint64_t abs_numerator = static_cast<uint64_t>(-numerator);
-        if (denominator > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
-            throw FractionException("Переполнение при получении обратной дроби");
+        uint64_t abs_numerator = FractionWide::magnitude(numerator);
+        if (denominator > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) ||
+            abs_numerator > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+            throw FractionException(FractionError::ReciprocalOverflow, operandOf(*this));
         }
         return Fraction(-static_cast<int64_t>(denominator), abs_numerator);
     }
@@ -241,16 +425,11 @@ bool Fraction::operator<(const Fraction& other) const {
     if (numerator < 0 && other.numerator >= 0) return true;
     if (numerator >= 0 && other.numerator < 0) return false;
 
-    if (numerator < 0) {
-        int64_t left = std::llabs(numerator) * static_cast<int64_t>(other.denominator);
-        int64_t right = std::llabs(other.numerator) * static_cast<int64_t>(denominator);
-        return left > right;
-    }
-    else {
-        int64_t left = numerator * static_cast<int64_t>(other.denominator);
-        int64_t right = other.numerator * static_cast<int64_t>(denominator);
-        return left < right;
-    }
+    // a/b < c/d  <=>  a*d < c*b, произведения сравниваются в 128 битах
+    int order = FractionWide::compareProducts(
+        FractionWide::magnitude(numerator), other.denominator,
+        FractionWide::magnitude(other.numerator), denominator);
+    return numerator < 0 ? order > 0 : order < 0;
 }
 
 bool Fraction::operator<=(const Fraction& other) const {
@@ -267,7 +446,7 @@ bool Fraction::operator>=(const Fraction& other) const {
 
 Fraction& Fraction::operator++() {
     if (willAdditionOverflow(numerator, static_cast<int64_t>(denominator))) {
-        throw FractionException("Переполнение при инкременте");
+        throw FractionException(FractionError::IncrementOverflow, operandOf(*this));
     }
     numerator += static_cast<int64_t>(denominator);
     reduce();
@@ -282,7 +461,7 @@ Fraction Fraction::operator++(int) {
 
 Fraction& Fraction::operator--() {
     if (willAdditionOverflow(numerator, -static_cast<int64_t>(denominator))) {
-        throw FractionException("Переполнение при декременте");
+        throw FractionException(FractionError::DecrementOverflow, operandOf(*this));
     }
     numerator -= static_cast<int64_t>(denominator);
     reduce();
@@ -316,11 +495,11 @@ Fraction& Fraction::operator/=(const Fraction& other) {
 }
 
 Fraction::operator double() const {
-    return static_cast<double>(numerator) / denominator;
+    return FractionWide::toDouble(numerator, denominator);
 }
 
 Fraction::operator float() const {
-    return static_cast<float>(numerator) / denominator;
+    return FractionWide::toFloat(numerator, denominator);
 }
 
 Fraction::operator int64_t() const {
@@ -329,7 +508,7 @@ Fraction::operator int64_t() const {
 
 Fraction::operator uint64_t() const {
     if (numerator < 0) {
-        throw FractionException("Отрицательная дробь не может быть приведена к uint64_t");
+        throw FractionException(FractionError::NegativeToUnsigned, operandOf(*this));
     }
     return static_cast<uint64_t>(numerator) / denominator;
 }
@@ -5,18 +5,81 @@
 #include <string>
 #include <stdexcept>
 #include <type_traits>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 
-// Пользовательский класс исключений для дробей
+// Коды ошибок дробей
+enum class FractionError : uint8_t {
+    ZeroDenominator,                // Знаменатель равен нулю
+    AdditionOverflow,
+    SubtractionOverflow,
+    MultiplicationOverflow,
+    DivisionByZero,
+    DivisionOverflow,
+    NegationOverflow,
+    ReciprocalOfZero,
+    ReciprocalOverflow,
+    IncrementOverflow,
+    DecrementOverflow,
+    NegativeToUnsigned,
+    EmptySketch,                    // Квантиль пустого эскиза
+    QuantileOutOfRange,
+    EmptyStatistics,
+    PrecisionLost,                  // Точное значение потеряно при переполнении
+    NotEnoughValues,
+    ConversionOverflow,             // Значение не помещается в дробь
+    NotANumber,                     // NaN или бесконечность
+    SizeMismatch,                   // Размеры массивов при пакетном преобразовании
+    InvalidScale,
+    Count                           // Число кодов; новые коды добавляются только перед ним
+};
+
+// Язык таблицы сообщений
+enum class FractionLanguage : uint8_t {
+    Russian,
+    English
+};
+
+// Операнд, сохраняемый в исключении
+struct FractionOperand {
+    int64_t numerator;
+    uint64_t denominator;
+};
+
+// Пользовательский класс исключений для дробей.
+// Сообщение берется из статической таблицы, операнды хранятся во встроенном
+// массиве, а текст what() собирается в фиксированный буфер при создании:
+// сам класс не выделяет память и what() безопасно вызывать из нескольких потоков.
+// Память под объект исключения выделяет среда выполнения (в Itanium ABI - в куче).
 class FractionException : public std::exception {
+public:
+    static constexpr std::size_t maxOperands = 2;
+
 private:
-    std::string message;
+    FractionError errorCode;
+    uint8_t operandCount;
+    FractionOperand operandValues[maxOperands];
+    char text[160];                 // Сообщение с операндами
+
+    void format() noexcept;
+
 public:
-    FractionException(const std::string& msg) : message(msg) {}
-    const char* what() const noexcept override {
-        return message.c_str();
-    }
+    explicit FractionException(FractionError code) noexcept;
+    FractionException(FractionError code, FractionOperand lhs) noexcept;
+    FractionException(FractionError code, FractionOperand lhs, FractionOperand rhs) noexcept;
+
+    FractionError code() const noexcept { return errorCode; }
+    std::size_t operandsCount() const noexcept { return operandCount; }
+    FractionOperand operand(std::size_t index) const noexcept { return operandValues[index]; }
+
+    const char* what() const noexcept override;
+
+    // Таблица сообщений
+    static const char* message(FractionError code) noexcept;
+    static const char* message(FractionError code, FractionLanguage language) noexcept;
+    static void setLanguage(FractionLanguage language) noexcept;
+    static FractionLanguage language() noexcept;
 };
 
 class Fraction {
@@ -25,14 +88,32 @@ private:
     uint64_t denominator;   // знаменатель (всегда > 0)
 
     // Приватные методы для приведения к канонической форме
-    int64_t gcd(int64_t a, int64_t b) const;  // НОД
+    static uint64_t gcd(uint64_t a, uint64_t b);  // НОД
     void reduce();          // Сокращение дроби
     void normalize();       // Приведение к канонической форме
 
+    // Точное представление числа с плавающей точкой (знаменатель - степень двойки)
+    static Fraction fromFloating(double value);
+
+    // Дробь из уже сокращенных частей, без нормализации
+    static Fraction fromReduced(int64_t num, uint64_t den);
+
+    // Точные арифметические ядра: промежуточные значения вычисляются в 128 битах,
+    // false только если сокращенный результат не помещается в дробь
+    static bool packParts(bool negative, uint64_t numHigh, uint64_t numLow,
+                          uint64_t denHigh, uint64_t denLow, int64_t& num, uint64_t& den);
+    static bool addParts(int64_t a, uint64_t b, bool cNegative, uint64_t cMagnitude, uint64_t d,
+                         int64_t& num, uint64_t& den);
+    static bool multiplyParts(bool aNegative, uint64_t aMagnitude, uint64_t b,
+                              bool cNegative, uint64_t cMagnitude, uint64_t d,
+                              int64_t& num, uint64_t& den);
+
     // Вспомогательные методы для безопасных операций
     static bool willAdditionOverflow(int64_t a, int64_t b);
-    static bool willMultiplicationOverflow(int64_t a, int64_t b);
-    static bool willMultiplicationOverflow(uint64_t a, uint64_t b);
+
+    // Атомарные обертки работают с полями напрямую, минуя нормализацию
+    friend class AtomicFraction;
+    friend class ConcurrentFractionSum;
 
 public:
     // Конструкторы
@@ -44,8 +125,18 @@ public:
 
     // Шаблонный конструктор для любого числового типа
     template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
-    Fraction(T value) : numerator(static_cast<int64_t>(value)), denominator(1) {
-        normalize();
+    Fraction(T value) : numerator(0), denominator(1) {
+        if constexpr (std::is_floating_point_v<T>) {
+            *this = fromFloating(static_cast<double>(value));
+        }
+        else {
+            if constexpr (std::is_unsigned_v<T> && sizeof(T) >= sizeof(int64_t)) {
+                if (value > static_cast<T>(std::numeric_limits<int64_t>::max())) {
+                    throw FractionException(FractionError::ConversionOverflow);
+                }
+            }
+            numerator = static_cast<int64_t>(value);
+        }
     }
 
     // Деструктор
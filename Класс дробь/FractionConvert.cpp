@@ -0,0 +1,273 @@
+﻿#include "FractionConvert.h"
+#include "FractionWide.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace {
+    constexpr uint64_t powersOfTen[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+        100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+        10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+        100000000000000000ULL, 1000000000000000000ULL
+    };
+
+    // Деление умножением на обратную величину inverse = floor((2^64 - 1) / divisor).
+    // 2^64 / divisor - inverse не больше 1, поэтому частное занижено меньше чем на 1
+    // и уточняется одним шагом по остатку.
+    class ReciprocalDivider {
+    private:
+        uint64_t divisor;
+        uint64_t inverse;
+
+    public:
+        ReciprocalDivider() : divisor(0), inverse(0) {
+        }
+
+        explicit ReciprocalDivider(uint64_t divisor)
+            : divisor(divisor), inverse(std::numeric_limits<uint64_t>::max() / divisor) {
+        }
+
+        uint64_t getDivisor() const { return divisor; }
+
+        uint64_t divide(uint64_t value, uint64_t& remainder) const {
+            uint64_t quotient, low;
+            FractionWide::multiply(value, inverse, quotient, low);
+            remainder = value - quotient * divisor;
+            // Коррекция без ветвления: ее нужность зависит от данных и плохо предсказывается
+            uint64_t correction = remainder >= divisor ? 1 : 0;
+            remainder -= divisor & (0 - correction);
+            return quotient + correction;
+        }
+    };
+
+    // Кэш обратных величин по знаменателю с прямым отображением.
+    // Знаменатели столбца после сокращения обычно принимают немного значений,
+    // но редко идут длинными сериями (x/100 дает 1, 2, 4, 5, ... вперемешку),
+    // поэтому обратная величина хранится для каждого встреченного знаменателя.
+    // Промах стоит одного деления - столько же, сколько деление без кэша
+    class CachedDivider {
+    private:
+        static constexpr int indexBits = 8;
+
+        ReciprocalDivider entries[std::size_t{ 1 } << indexBits];
+
+        static std::size_t indexOf(uint64_t den) {
+            // Фибоначчиево хеширование: соседние и кратные знаменатели попадают в разные ячейки
+            return static_cast<std::size_t>((den * 0x9E3779B97F4A7C15ULL) >> (64 - indexBits));
+        }
+
+    public:
+        uint64_t divide(uint64_t value, uint64_t den, uint64_t& remainder) {
+            ReciprocalDivider& entry = entries[indexOf(den)];
+            if (entry.getDivisor() != den) {
+                entry = ReciprocalDivider(den);
+            }
+            return entry.divide(value, remainder);
+        }
+    };
+
+    void requireSameSize(std::size_t inputSize, std::size_t outputSize) {
+        if (inputSize != outputSize) {
+            throw FractionException(FractionError::SizeMismatch);
+        }
+    }
+
+    // 1, если модуль частного quotient + remainder / divisor нужно увеличить.
+    // Режим - параметр шаблона, чтобы выбор не повторялся для каждого элемента;
+    // условия записаны без ветвлений, потому что зависят от данных.
+    // 2 * remainder не переполняется: знаменатель дроби не больше INT64_MAX
+    template<RoundingMode Mode>
+    uint64_t roundsUp(uint64_t quotient, uint64_t remainder, uint64_t divisor, bool negative) {
+        if constexpr (Mode == RoundingMode::Floor) {
+            return static_cast<uint64_t>(remainder != 0) & static_cast<uint64_t>(negative);
+        }
+        else if constexpr (Mode == RoundingMode::Ceil) {
+            return static_cast<uint64_t>(remainder != 0) & static_cast<uint64_t>(!negative);
+        }
+        else if constexpr (Mode == RoundingMode::Trunc) {
+            return 0;
+        }
+        else if constexpr (Mode == RoundingMode::HalfEven) {
+            // Половина округляется вверх только при нечетном частном
+            return static_cast<uint64_t>(2 * remainder + (quotient & 1) > divisor);
+        }
+        else {
+            return static_cast<uint64_t>(2 * remainder >= divisor);
+        }
+    }
+
+    [[noreturn]] void throwConversionOverflow(const Fraction& value) {
+        throw FractionException(FractionError::ConversionOverflow,
+            FractionOperand{ value.getNumerator(), value.getDenominator() });
+    }
+
+    // round(value * scale) для элемента с |num| > INT64_MAX / scale: произведение
+    // считается в 128 битах, а результат проверяется на переполнение
+    template<RoundingMode Mode>
+    int64_t scaleAndRoundWide(const Fraction& value, uint64_t scale) {
+        constexpr uint64_t maxPositive = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+        uint64_t den = value.getDenominator();
+        bool negative = value.getNumerator() < 0;
+
+        uint64_t high, low, remainder;
+        FractionWide::multiply(FractionWide::magnitude(value.getNumerator()), scale, high, low);
+        if (high >= den) {
+            throwConversionOverflow(value);
+        }
+        uint64_t quotient = FractionWide::divide(high, low, den, remainder);
+        // quotient + up не больше 2^63 - 1 (2^63 для отрицательных); при quotient = 2^64 - 1
+        // проверка срабатывает раньше, чем сложение переполнится
+        uint64_t up = roundsUp<Mode>(quotient, remainder, den, negative);
+        if (quotient > maxPositive + (negative ? 1 : 0) - up) {
+            throwConversionOverflow(value);
+        }
+        quotient += up;
+        return negative ? static_cast<int64_t>(0 - quotient) : static_cast<int64_t>(quotient);
+    }
+
+    // round(value * scale) для каждого элемента; toInteger - частный случай scale = 1.
+    // При |num| <= INT64_MAX / scale произведение - обычное 64-битное умножение, а результат
+    // заведомо помещается в int64_t (частное не больше делимого, округление вверх
+    // возможно только при знаменателе от 2), поэтому в цикле нет проверок переполнения.
+    // Знак в столбце обычно случаен, поэтому модуль и знак получаются маской, а не ветвлением
+    template<RoundingMode Mode>
+    void scaleAndRound(std::span<const Fraction> input, std::span<int64_t> output, uint64_t scale) {
+        const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) / scale;
+        CachedDivider divider;
+
+        for (std::size_t i = 0; i < input.size(); i++) {
+            const Fraction& value = input[i];
+            uint64_t signMask = static_cast<uint64_t>(value.getNumerator() >> 63);
+            uint64_t magnitude = (static_cast<uint64_t>(value.getNumerator()) ^ signMask) - signMask;
+            if (magnitude > limit) {
+                output[i] = scaleAndRoundWide<Mode>(value, scale);
+                continue;
+            }
+
+            uint64_t den = value.getDenominator();
+            uint64_t remainder;
+            uint64_t quotient = divider.divide(magnitude * scale, den, remainder);
+            quotient += roundsUp<Mode>(quotient, remainder, den, signMask != 0);
+            output[i] = static_cast<int64_t>((quotient ^ signMask) - signMask);
+        }
+    }
+
+    void scaleAndRound(std::span<const Fraction> input, std::span<int64_t> output,
+                       uint64_t scale, RoundingMode mode) {
+        switch (mode) {
+        case RoundingMode::Floor:
+            scaleAndRound<RoundingMode::Floor>(input, output, scale);
+            break;
+        case RoundingMode::Ceil:
+            scaleAndRound<RoundingMode::Ceil>(input, output, scale);
+            break;
+        case RoundingMode::Trunc:
+            scaleAndRound<RoundingMode::Trunc>(input, output, scale);
+            break;
+        case RoundingMode::HalfEven:
+            scaleAndRound<RoundingMode::HalfEven>(input, output, scale);
+            break;
+        case RoundingMode::HalfAwayFromZero:
+            scaleAndRound<RoundingMode::HalfAwayFromZero>(input, output, scale);
+            break;
+        }
+    }
+
+    // Элементов в блоке: проверка, деление и исправление идут по блоку, пока он в кэше
+    constexpr std::size_t blockSize = 256;
+
+    // Преобразование int64_t в double/float (cvtsi2sd) векторизуется только с AVX-512,
+    // поэтому векторный цикл берет операнды в границах, где есть векторный аналог:
+    // для float - через int32_t, для double - через мантиссу константы 1.5 * 2^52
+    template<typename Floating>
+    constexpr int vectorDigits = std::is_same_v<Floating, float> ? 24 : 50;
+
+    // 0, если оба операнда в этих границах. Целое, а не bool: так проверка блока
+    // сводится к векторному OR
+    template<typename Floating>
+    uint64_t outsideVector(const Fraction& value) {
+        constexpr uint64_t limit = uint64_t{ 1 } << vectorDigits<Floating>;
+        return static_cast<uint64_t>(static_cast<uint64_t>(value.getNumerator()) + limit > 2 * limit) |
+            static_cast<uint64_t>(value.getDenominator() > limit);
+    }
+
+    // Точное значение целого |value| <= 2^vectorDigits
+    template<typename Floating>
+    Floating convertExact(int64_t value) {
+        if constexpr (std::is_same_v<Floating, float>) {
+            return static_cast<float>(static_cast<int32_t>(value));
+        }
+        else {
+            // 1.5 * 2^52 + value при |value| < 2^51 точно записывается в мантиссу
+            constexpr double bias = 6755399441055744.0;
+            return std::bit_cast<double>(std::bit_cast<uint64_t>(bias) + static_cast<uint64_t>(value)) - bias;
+        }
+    }
+
+    template<typename Floating>
+    Floating toFloating(const Fraction& value) {
+        if constexpr (std::is_same_v<Floating, float>) {
+            return FractionWide::toFloat(value.getNumerator(), value.getDenominator());
+        }
+        else {
+            return FractionWide::toDouble(value.getNumerator(), value.getDenominator());
+        }
+    }
+
+    // Деление IEEE (и векторное тоже) корректно округляется, если операнды точны.
+    // Поэтому блок сначала проверяется целиком, затем делится циклом без ветвлений,
+    // который компилятор векторизует, и только не прошедшие проверку элементы
+    // пересчитываются через FractionWide
+    template<typename Floating>
+    void toFloating(std::span<const Fraction> input, std::span<Floating> output) {
+        for (std::size_t start = 0; start < input.size(); start += blockSize) {
+            std::size_t end = std::min(start + blockSize, input.size());
+
+            uint64_t outside = 0;
+            for (std::size_t i = start; i < end; i++) {
+                outside |= outsideVector<Floating>(input[i]);
+            }
+            for (std::size_t i = start; i < end; i++) {
+                output[i] = convertExact<Floating>(input[i].getNumerator()) /
+                    convertExact<Floating>(static_cast<int64_t>(input[i].getDenominator()));
+            }
+            if (outside != 0) {
+                for (std::size_t i = start; i < end; i++) {
+                    if (outsideVector<Floating>(input[i]) != 0) {
+                        output[i] = toFloating<Floating>(input[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+namespace FractionConvert {
+
+    void toDouble(std::span<const Fraction> input, std::span<double> output) {
+        requireSameSize(input.size(), output.size());
+        toFloating(input, output);
+    }
+
+    void toFloat(std::span<const Fraction> input, std::span<float> output) {
+        requireSameSize(input.size(), output.size());
+        toFloating(input, output);
+    }
+
+    void toFixedPoint(std::span<const Fraction> input, std::span<int64_t> output,
+                      int scaleDigits, RoundingMode mode) {
+        requireSameSize(input.size(), output.size());
+        if (scaleDigits < 0 || scaleDigits > 18) {
+            throw FractionException(FractionError::InvalidScale);
+        }
+        scaleAndRound(input, output, powersOfTen[scaleDigits], mode);
+    }
+
+    void toInteger(std::span<const Fraction> input, std::span<int64_t> output, RoundingMode mode) {
+        requireSameSize(input.size(), output.size());
+        scaleAndRound(input, output, 1, mode);
+    }
+}
@@ -0,0 +1,35 @@
+﻿#ifndef FRACTION_CONVERT_H
+#define FRACTION_CONVERT_H
+
+#include "Fraction.h"
+#include <cstdint>
+#include <span>
+
+// Режимы округления при преобразовании в целые числа
+enum class RoundingMode : uint8_t {
+    Floor,              // К минус бесконечности
+    Ceil,               // К плюс бесконечности
+    Trunc,              // К нулю
+    HalfEven,           // К ближайшему, половина - к четному
+    HalfAwayFromZero    // К ближайшему, половина - от нуля
+};
+
+// Пакетные преобразования массивов дробей.
+// Размеры input и output должны совпадать. При ошибке в элементе выбрасывается
+// исключение; элементы до него уже записаны в output.
+namespace FractionConvert {
+
+    // Корректно округленные значения (как static_cast<double>/<float>)
+    void toDouble(std::span<const Fraction> input, std::span<double> output);
+    void toFloat(std::span<const Fraction> input, std::span<float> output);
+
+    // Фиксированная точка: round(value * 10^scaleDigits), scaleDigits от 0 до 18
+    void toFixedPoint(std::span<const Fraction> input, std::span<int64_t> output,
+                      int scaleDigits, RoundingMode mode = RoundingMode::HalfEven);
+
+    // Целая часть с заданным округлением (Trunc совпадает с static_cast<int64_t>)
+    void toInteger(std::span<const Fraction> input, std::span<int64_t> output,
+                   RoundingMode mode = RoundingMode::Trunc);
+}
+
+#endif
@@ -0,0 +1,330 @@
+﻿#include "FractionStatistics.h"
+#include <algorithm>
+#include <utility>
+
+QuantileSketch::QuantileSketch(std::size_t capacity)
+    : capacity(capacity < 2 ? 2 : capacity), levels(1), count(0), oddOffset(false) {
+}
+
+void QuantileSketch::compact(std::size_t level) {
+    if (level + 1 == levels.size()) {
+        levels.emplace_back();
+    }
+
+    std::vector<double>& items = levels[level];
+    std::sort(items.begin(), items.end());
+
+    // При нечетном числе элементов последний остается на уровне
+    double leftover = 0.0;
+    bool hasLeftover = items.size() % 2 != 0;
+    if (hasLeftover) {
+        leftover = items.back();
+        items.pop_back();
+    }
+
+    std::vector<double>& next = levels[level + 1];
+    for (std::size_t i = oddOffset ? 1 : 0; i < items.size(); i += 2) {
+        next.push_back(items[i]);
+    }
+    oddOffset = !oddOffset;
+
+    items.clear();
+    if (hasLeftover) {
+        items.push_back(leftover);
+    }
+}
+
+void QuantileSketch::add(double value) {
+    levels[0].push_back(value);
+    count++;
+
+    for (std::size_t level = 0; level < levels.size() && levels[level].size() >= capacity; level++) {
+        compact(level);
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    // Вставка диапазона вектора в сам вектор - неопределенное поведение
+    if (&other == this) {
+        QuantileSketch copy(other);
+        merge(copy);
+        return;
+    }
+    if (other.levels.size() > levels.size()) {
+        levels.resize(other.levels.size());
+    }
+    for (std::size_t level = 0; level < other.levels.size(); level++) {
+        levels[level].insert(levels[level].end(), other.levels[level].begin(), other.levels[level].end());
+    }
+    count += other.count;
+
+    for (std::size_t level = 0; level < levels.size(); level++) {
+        if (levels[level].size() >= capacity) {
+            compact(level);
+        }
+    }
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (count == 0) {
+        throw FractionException(FractionError::EmptySketch);
+    }
+    if (!(q >= 0.0 && q <= 1.0)) {
+        throw FractionException(FractionError::QuantileOutOfRange);
+    }
+
+    std::vector<std::pair<double, uint64_t>> weighted;
+    weighted.reserve(retained());
+    uint64_t totalWeight = 0;
+    for (std::size_t level = 0; level < levels.size(); level++) {
+        uint64_t weight = uint64_t{ 1 } << level;
+        for (double value : levels[level]) {
+            weighted.emplace_back(value, weight);
+            totalWeight += weight;
+        }
+    }
+    std::sort(weighted.begin(), weighted.end());
+
+    double target = q * static_cast<double>(totalWeight);
+    uint64_t accumulated = 0;
+    for (const auto& item : weighted) {
+        accumulated += item.second;
+        if (static_cast<double>(accumulated) >= target) {
+            return item.first;
+        }
+    }
+    return weighted.back().first;
+}
+
+std::size_t QuantileSketch::retained() const {
+    std::size_t result = 0;
+    for (const auto& level : levels) {
+        result += level.size();
+    }
+    return result;
+}
+
+FractionStatistics::FractionStatistics(std::size_t sketchCapacity)
+    : n(0), sumExact(true), varianceExact(true), sketch(sketchCapacity) {
+}
+
+ScaledValue FractionStatistics::scaledTotal() const {
+    return sumExact ? ScaledValue::fromFraction(total) : approxTotal;
+}
+
+ScaledValue FractionStatistics::scaledM2() const {
+    return varianceExact ? ScaledValue::fromFraction(m2) : approxM2;
+}
+
+ScaledValue FractionStatistics::scaledMean() const {
+    return n == 0 ? ScaledValue() : scaledTotal() / n;
+}
+
+void FractionStatistics::addToTotal(const Fraction& value) {
+    if (sumExact) {
+        try {
+            total = total + value;
+            return;
+        }
+        catch (const FractionException&) {
+            // total не изменен: дальше сумма накапливается приближенно
+            approxTotal = ScaledValue::fromFraction(total);
+            sumExact = false;
+        }
+    }
+    approxTotal = approxTotal + ScaledValue::fromFraction(value);
+}
+
+void FractionStatistics::switchVarianceToApproximate() {
+    approxM2 = ScaledValue::fromFraction(m2);
+    approxMean = ScaledValue::fromFraction(runningMean);
+    varianceExact = false;
+}
+
+void FractionStatistics::add(const Fraction& value) {
+    n++;
+
+    if (n == 1) {
+        minimum = value;
+        maximum = value;
+    }
+    else if (value < minimum) {
+        minimum = value;
+    }
+    else if (value > maximum) {
+        maximum = value;
+    }
+    sketch.add(static_cast<double>(value));
+
+    addToTotal(value);
+
+    if (varianceExact) {
+        try {
+            Fraction delta = value - runningMean;
+            Fraction newMean = runningMean + delta / static_cast<int64_t>(n);
+            Fraction newM2 = m2 + delta * (value - newMean);
+
+            runningMean = newMean;
+            m2 = newM2;
+            return;
+        }
+        catch (const FractionException&) {
+            // Состояние не изменено: продолжаем приближенно
+            switchVarianceToApproximate();
+        }
+    }
+
+    // Шаг Уэлфорда в ScaledValue; новое среднее берется из суммы, а не накапливается
+    ScaledValue x = ScaledValue::fromFraction(value);
+    ScaledValue newMean = scaledMean();
+    approxM2 = approxM2 + (x - approxMean) * (x - newMean);
+    approxMean = newMean;
+}
+
+FractionStatistics& FractionStatistics::operator+=(const Fraction& value) {
+    add(value);
+    return *this;
+}
+
+void FractionStatistics::merge(const FractionStatistics& other) {
+    // Состояние меняется по ходу объединения, поэтому с самим собой - через копию
+    if (&other == this) {
+        FractionStatistics copy(other);
+        merge(copy);
+        return;
+    }
+    if (other.n == 0) {
+        return;
+    }
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+
+    uint64_t combined = n + other.n;
+
+    bool varianceMerged = false;
+    if (varianceExact && other.varianceExact) {
+        try {
+            Fraction delta = other.runningMean - runningMean;
+            Fraction weight = Fraction(static_cast<int64_t>(other.n), combined);
+            Fraction newMean = runningMean + delta * weight;
+            Fraction newM2 = m2 + other.m2 + delta * delta * weight * static_cast<int64_t>(n);
+
+            runningMean = newMean;
+            m2 = newM2;
+            varianceMerged = true;
+        }
+        catch (const FractionException&) {
+        }
+    }
+    if (!varianceMerged) {
+        // Средние частей - из их сумм (до объединения total)
+        ScaledValue delta = other.scaledMean() - scaledMean();
+        ScaledValue weight = ScaledValue::fromInteger(n) * ScaledValue::fromInteger(other.n) / combined;
+        approxM2 = scaledM2() + other.scaledM2() + delta * delta * weight;
+        varianceExact = false;
+    }
+
+    bool sumMerged = false;
+    if (sumExact && other.sumExact) {
+        try {
+            total = total + other.total;
+            sumMerged = true;
+        }
+        catch (const FractionException&) {
+        }
+    }
+    if (!sumMerged) {
+        approxTotal = scaledTotal() + other.scaledTotal();
+        sumExact = false;
+    }
+
+    n = combined;
+    if (!varianceExact) {
+        approxMean = scaledMean();
+    }
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    sketch.merge(other.sketch);
+}
+
+void FractionStatistics::requireData() const {
+    if (n == 0) {
+        throw FractionException(FractionError::EmptyStatistics);
+    }
+}
+
+Fraction FractionStatistics::sum() const {
+    if (!sumExact) {
+        throw FractionException(FractionError::PrecisionLost);
+    }
+    return total;
+}
+
+Fraction FractionStatistics::mean() const {
+    requireData();
+    if (sumExact) {
+        return total / static_cast<int64_t>(n);
+    }
+    // Сумма переполнилась, но среднее шага Уэлфорда еще точное и равно total / n
+    if (varianceExact) {
+        return runningMean;
+    }
+    throw FractionException(FractionError::PrecisionLost);
+}
+
+Fraction FractionStatistics::variance() const {
+    requireData();
+    if (!varianceExact) {
+        throw FractionException(FractionError::PrecisionLost);
+    }
+    return m2 / static_cast<int64_t>(n);
+}
+
+Fraction FractionStatistics::sampleVariance() const {
+    requireData();
+    if (!varianceExact) {
+        throw FractionException(FractionError::PrecisionLost);
+    }
+    if (n < 2) {
+        throw FractionException(FractionError::NotEnoughValues);
+    }
+    return m2 / static_cast<int64_t>(n - 1);
+}
+
+double FractionStatistics::sumApprox() const {
+    return scaledTotal().toDouble();
+}
+
+double FractionStatistics::meanApprox() const {
+    requireData();
+    return scaledMean().toDouble();
+}
+
+double FractionStatistics::varianceApprox() const {
+    requireData();
+    return (scaledM2() / n).toDouble();
+}
+
+double FractionStatistics::sampleVarianceApprox() const {
+    requireData();
+    if (n < 2) {
+        throw FractionException(FractionError::NotEnoughValues);
+    }
+    return (scaledM2() / (n - 1)).toDouble();
+}
+
+Fraction FractionStatistics::min() const {
+    requireData();
+    return minimum;
+}
+
+Fraction FractionStatistics::max() const {
+    requireData();
+    return maximum;
+}
+
+double FractionStatistics::quantile(double q) const {
+    return sketch.quantile(q);
+}
@@ -0,0 +1,98 @@
+﻿#ifndef FRACTION_STATISTICS_H
+#define FRACTION_STATISTICS_H
+
+#include "Fraction.h"
+#include "ScaledValue.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Приближенный эскиз квантилей с ограниченной памятью (упрощенный KLL).
+// Уровень i хранит элементы с весом 2^i; заполненный уровень сортируется
+// и половина его элементов переносится на следующий уровень.
+// Память: O(capacity * log(n / capacity)).
+class QuantileSketch {
+private:
+    std::size_t capacity;                   // Вместимость одного уровня
+    std::vector<std::vector<double>> levels;
+    uint64_t count;
+    bool oddOffset;                         // Чередование выбираемой половины при сжатии
+
+    void compact(std::size_t level);        // Сжатие уровня в следующий
+
+public:
+    explicit QuantileSketch(std::size_t capacity = 256);
+
+    void add(double value);
+    void merge(const QuantileSketch& other);
+
+    double quantile(double q) const;        // q из [0, 1]
+    uint64_t size() const { return count; }
+    std::size_t retained() const;           // Число хранимых элементов
+};
+
+// Однопроходная статистика по потоку дробей.
+// Сумма хранится точно, пока помещается в дробь; среднее вычисляется
+// из нее по запросу (total / n). Сумма квадратов отклонений (метод Уэлфорда)
+// считается точно, пока хватает разрядности, затем переходит в ScaledValue
+// (63-битная мантисса с двоичным порядком). Переполнение одной величины
+// не лишает точности другую.
+class FractionStatistics {
+private:
+    uint64_t n;
+    bool sumExact;
+    bool varianceExact;
+
+    Fraction total;             // Точная сумма (пока sumExact)
+    ScaledValue approxTotal;    // Сумма после переполнения total
+
+    Fraction runningMean;       // Среднее для шага Уэлфорда (пока varianceExact)
+    Fraction m2;                // Сумма квадратов отклонений от среднего
+    ScaledValue approxMean;     // То же после переполнения m2
+    ScaledValue approxM2;
+
+    Fraction minimum;
+    Fraction maximum;
+    QuantileSketch sketch;
+
+    ScaledValue scaledTotal() const;
+    ScaledValue scaledM2() const;
+    ScaledValue scaledMean() const;         // Сумма / n
+    void addToTotal(const Fraction& value);
+    void switchVarianceToApproximate();     // Перенос m2 и среднего в ScaledValue
+    void requireData() const;
+
+public:
+    explicit FractionStatistics(std::size_t sketchCapacity = 256);
+
+    void add(const Fraction& value);
+    FractionStatistics& operator+=(const Fraction& value);
+
+    // Объединение частичных состояний (формула Чана)
+    void merge(const FractionStatistics& other);
+
+    uint64_t count() const { return n; }
+    bool isSumExact() const { return sumExact; }
+    bool isVarianceExact() const { return varianceExact; }
+    bool isExact() const { return sumExact && varianceExact; }
+
+    // Точные значения (PrecisionLost, если соответствующая величина приближенная).
+    // mean() делит точную сумму на n и бросает DivisionOverflow, если результат не помещается
+    Fraction sum() const;
+    Fraction mean() const;
+    Fraction variance() const;              // Дисперсия генеральной совокупности
+    Fraction sampleVariance() const;        // Выборочная дисперсия (n - 1)
+
+    // Значения в double (доступны всегда)
+    double sumApprox() const;
+    double meanApprox() const;
+    double varianceApprox() const;
+    double sampleVarianceApprox() const;
+
+    Fraction min() const;
+    Fraction max() const;
+    double quantile(double q) const;        // Приближенный квантиль
+    const QuantileSketch& quantiles() const { return sketch; }
+};
+
+#endif
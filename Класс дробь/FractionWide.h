@@ -0,0 +1,160 @@
+﻿#ifndef FRACTION_WIDE_H
+#define FRACTION_WIDE_H
+
+// Внутренние 128-битные операции для точных сравнений и преобразований
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace FractionWide {
+
+    // Модуль числа без переполнения для INT64_MIN
+    inline uint64_t magnitude(int64_t value) {
+        return value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    }
+
+    // Полное произведение a * b = high * 2^64 + low
+    inline void multiply(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        low = _umul128(a, b, &high);
+#elif defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        high = static_cast<uint64_t>(product >> 64);
+        low = static_cast<uint64_t>(product);
+#else
+        uint64_t aLow = a & 0xFFFFFFFFu, aHigh = a >> 32;
+        uint64_t bLow = b & 0xFFFFFFFFu, bHigh = b >> 32;
+        uint64_t lowLow = aLow * bLow;
+        uint64_t highLow = aHigh * bLow;
+        uint64_t lowHigh = aLow * bHigh;
+        uint64_t highHigh = aHigh * bHigh;
+        uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFu) + (lowHigh & 0xFFFFFFFFu);
+        high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+        low = (middle << 32) | (lowLow & 0xFFFFFFFFu);
+#endif
+    }
+
+    // Сравнение a * b и c * d: -1, 0 или 1
+    inline int compareProducts(uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
+        uint64_t leftHigh, leftLow, rightHigh, rightLow;
+        multiply(a, b, leftHigh, leftLow);
+        multiply(c, d, rightHigh, rightLow);
+        if (leftHigh != rightHigh) {
+            return leftHigh < rightHigh ? -1 : 1;
+        }
+        if (leftLow != rightLow) {
+            return leftLow < rightLow ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // Деление (high * 2^64 + low) / divisor, требуется high < divisor
+    inline uint64_t divide(uint64_t high, uint64_t low, uint64_t divisor, uint64_t& remainder) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return _udiv128(high, low, divisor, &remainder);
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        // Деление unsigned __int128 вызывает библиотечную __udivti3; при high < divisor
+        // частное помещается в 64 бита и хватает одной инструкции, как _udiv128
+        uint64_t quotient;
+        __asm__("divq %[divisor]" : "=a"(quotient), "=d"(remainder) : [divisor] "rm"(divisor), "a"(low), "d"(high));
+        return quotient;
+#elif defined(__SIZEOF_INT128__)
+        unsigned __int128 dividend = (static_cast<unsigned __int128>(high) << 64) | low;
+        remainder = static_cast<uint64_t>(dividend % divisor);
+        return static_cast<uint64_t>(dividend / divisor);
+#else
+        uint64_t quotient = 0;
+        for (int bit = 63; bit >= 0; bit--) {
+            bool carry = (high >> 63) != 0;
+            high = (high << 1) | (low >> 63);
+            low <<= 1;
+            quotient <<= 1;
+            if (carry || high >= divisor) {
+                high -= divisor;
+                quotient |= 1;
+            }
+        }
+        remainder = high;
+        return quotient;
+#endif
+    }
+
+    // Частное |num| / den с 63 значащими битами:
+    // |num| / den = quotient * 2^-shift, младший бит quotient учитывает остаток.
+    // До нормализации shift от 0 (|num| = 2^63, den = 1) до 126, после - от -1 до 126
+    inline int64_t scaledQuotient(uint64_t magnitude, uint64_t den, int& shift) {
+        shift = 63 + static_cast<int>(std::bit_width(den)) - static_cast<int>(std::bit_width(magnitude));
+        uint64_t high = 0;
+        uint64_t low = magnitude;
+        if (shift >= 64) {
+            high = magnitude << (shift - 64);
+            low = 0;
+        }
+        else if (shift > 0) {
+            high = magnitude >> (64 - shift);
+            low = magnitude << shift;
+        }
+
+        // Делимое меньше 2^(63 + bit_width(den)), поэтому high < den
+        uint64_t remainder;
+        uint64_t quotient = divide(high, low, den, remainder);
+        if (remainder != 0) {
+            quotient |= 1;
+        }
+        // Перевод в int64_t для корректно округляемого знакового преобразования
+        if (quotient >> 63) {
+            quotient = (quotient >> 1) | (quotient & 1);
+            shift--;
+        }
+        return static_cast<int64_t>(quotient);
+    }
+
+    // |num| <= 2^digits: число точно представимо в типе с digits битами мантиссы
+    // (проверка без ветвления по знаку)
+    inline bool isExactIn(int64_t num, int digits) {
+        uint64_t limit = uint64_t{ 1 } << digits;
+        return static_cast<uint64_t>(num) + limit <= 2 * limit;
+    }
+
+    // Корректно округленное num / den в double
+    inline double toDouble(int64_t num, uint64_t den) {
+        constexpr uint64_t exactLimit = uint64_t{ 1 } << 53;
+        if (isExactIn(num, 53) && den <= exactLimit) {
+            // Оба операнда точны, деление IEEE округляется один раз
+            return static_cast<double>(num) / static_cast<double>(den);
+        }
+        if (std::has_single_bit(den)) {
+            // Умножение на точную обратную степень двойки округляется один раз
+            return std::ldexp(static_cast<double>(num), -static_cast<int>(std::countr_zero(den)));
+        }
+
+        int shift = 0;
+        int64_t quotient = scaledQuotient(magnitude(num), den, shift);
+        double result = std::ldexp(static_cast<double>(quotient), -shift);
+        return num < 0 ? -result : result;
+    }
+
+    // Корректно округленное num / den в float. Частное, посчитанное в double,
+    // сюда не годится: второе округление в float ошибается рядом с серединами
+    inline float toFloat(int64_t num, uint64_t den) {
+        constexpr uint64_t exactLimit = uint64_t{ 1 } << 24;
+        if (isExactIn(num, 24) && den <= exactLimit) {
+            return static_cast<float>(num) / static_cast<float>(den);
+        }
+        if (std::has_single_bit(den)) {
+            return std::ldexp(static_cast<float>(num), -static_cast<int>(std::countr_zero(den)));
+        }
+
+        int shift = 0;
+        int64_t quotient = scaledQuotient(magnitude(num), den, shift);
+        float result = std::ldexp(static_cast<float>(quotient), -shift);
+        return num < 0 ? -result : result;
+    }
+}
+
+#endif
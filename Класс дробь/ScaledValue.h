@@ -0,0 +1,163 @@
+﻿#ifndef SCALED_VALUE_H
+#define SCALED_VALUE_H
+
+#include "Fraction.h"
+#include "FractionWide.h"
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+// Приближенное число с масштабом: value = ±magnitude * 2^exponent,
+// magnitude нормализован к [2^62, 2^63) (63 значащих бита, у double 53).
+// Используется вместо long double, который в MSVC совпадает с double.
+// Сложение и умножение округляются к ближайшему, деление на целое
+// и построение из дроби - с ошибкой не больше единицы младшего разряда.
+class ScaledValue {
+private:
+    bool negative;
+    uint64_t magnitude;     // 0 только для нуля
+    int exponent;
+
+    static constexpr int precision = 63;
+
+    ScaledValue(bool negative, uint64_t magnitude, int exponent)
+        : negative(negative), magnitude(magnitude), exponent(exponent) {
+    }
+
+    // Нормализация 128-битного модуля (high * 2^64 + low) * 2^exponent
+    static ScaledValue normalize(bool negative, uint64_t high, uint64_t low, int exponent) {
+        int width = high != 0 ? 64 + static_cast<int>(std::bit_width(high)) : static_cast<int>(std::bit_width(low));
+        if (width == 0) {
+            return ScaledValue();
+        }
+
+        int shift = width - precision;
+        if (shift <= 0) {
+            // Модуль помещается в low, сдвиг влево точен
+            return ScaledValue(negative, low << -shift, exponent + shift);
+        }
+
+        // Сдвиг вправо на 1..65 бит с округлением к ближайшему, половина - к четному.
+        // comparison - знак разности отброшенной части и половины младшего разряда
+        uint64_t result;
+        int comparison;
+        if (shift < 64) {
+            uint64_t dropped = low & ((uint64_t{ 1 } << shift) - 1);
+            uint64_t half = uint64_t{ 1 } << (shift - 1);
+            result = (high << (64 - shift)) | (low >> shift);
+            comparison = dropped < half ? -1 : (dropped > half ? 1 : 0);
+        }
+        else if (shift == 64) {
+            constexpr uint64_t half = uint64_t{ 1 } << 63;
+            result = high;
+            comparison = low < half ? -1 : (low > half ? 1 : 0);
+        }
+        else {
+            result = high >> 1;
+            comparison = (high & 1) == 0 ? -1 : (low != 0 ? 1 : 0);
+        }
+        if (comparison > 0 || (comparison == 0 && (result & 1) != 0)) {
+            result++;
+        }
+        return finish(negative, result, exponent + shift);
+    }
+
+    // Округление могло дать 2^63
+    static ScaledValue finish(bool negative, uint64_t result, int exponent) {
+        if (result >> precision) {
+            result >>= 1;
+            exponent++;
+        }
+        return ScaledValue(negative, result, exponent);
+    }
+
+public:
+    ScaledValue() : negative(false), magnitude(0), exponent(0) {}
+
+    static ScaledValue fromInteger(uint64_t value) {
+        return normalize(false, 0, value, 0);
+    }
+
+    static ScaledValue fromFraction(const Fraction& value) {
+        if (value.getNumerator() == 0) {
+            return ScaledValue();
+        }
+        int shift = 0;
+        uint64_t quotient = static_cast<uint64_t>(
+            FractionWide::scaledQuotient(FractionWide::magnitude(value.getNumerator()), value.getDenominator(), shift));
+        return normalize(value.getNumerator() < 0, 0, quotient, -shift);
+    }
+
+    bool isZero() const { return magnitude == 0; }
+
+    ScaledValue operator-() const {
+        return ScaledValue(!negative && magnitude != 0, magnitude, exponent);
+    }
+
+    ScaledValue operator+(const ScaledValue& other) const {
+        if (other.isZero()) {
+            return *this;
+        }
+        if (isZero()) {
+            return other;
+        }
+        const ScaledValue& larger = exponent >= other.exponent ? *this : other;
+        const ScaledValue& smaller = exponent >= other.exponent ? other : *this;
+
+        // Меньшее слагаемое меньше четверти младшего разряда большего
+        int distance = larger.exponent - smaller.exponent;
+        if (distance > 64) {
+            return larger;
+        }
+
+        // Большее слагаемое сдвигается влево на distance (не больше 127 бит)
+        uint64_t high = distance == 0 ? 0 : larger.magnitude >> (64 - distance);
+        uint64_t low = distance == 64 ? 0 : larger.magnitude << distance;
+
+        if (larger.negative == smaller.negative) {
+            uint64_t sum = low + smaller.magnitude;
+            high += sum < low ? 1 : 0;
+            return normalize(larger.negative, high, sum, smaller.exponent);
+        }
+
+        // Разные знаки: из большего по модулю вычитается меньшее
+        bool largerWins = high != 0 || low >= smaller.magnitude;
+        if (largerWins) {
+            uint64_t difference = low - smaller.magnitude;
+            high -= low < smaller.magnitude ? 1 : 0;
+            return normalize(larger.negative, high, difference, smaller.exponent);
+        }
+        return normalize(smaller.negative, 0, smaller.magnitude - low, smaller.exponent);
+    }
+
+    ScaledValue operator-(const ScaledValue& other) const {
+        return *this + (-other);
+    }
+
+    ScaledValue operator*(const ScaledValue& other) const {
+        if (isZero() || other.isZero()) {
+            return ScaledValue();
+        }
+        uint64_t high, low;
+        FractionWide::multiply(magnitude, other.magnitude, high, low);
+        return normalize(negative != other.negative, high, low, exponent + other.exponent);
+    }
+
+    // Деление на натуральное число: одно 128-битное деление через scaledQuotient,
+    // ненулевой остаток учитывается в младшем бите
+    ScaledValue operator/(uint64_t divisor) const {
+        if (isZero()) {
+            return ScaledValue();
+        }
+        int shift = 0;
+        uint64_t quotient = static_cast<uint64_t>(FractionWide::scaledQuotient(magnitude, divisor, shift));
+        return normalize(negative, 0, quotient, exponent - shift);
+    }
+
+    double toDouble() const {
+        double result = std::ldexp(static_cast<double>(static_cast<int64_t>(magnitude)), exponent);
+        return negative ? -result : result;
+    }
+};
+
+#endif
@@ -3,8 +3,30 @@
 #include <vector>
 #include <windows.h>
 #include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include "Fraction.h"
 #include "FractionOperators.h"
+#include "AtomicFraction.h"
+#include "FractionStatistics.h"
+#include "FractionConvert.h"
+
+// Время выполнения body(i) в threadCount потоках, мс
+template<typename Body>
+double measureThreads(int threadCount, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(body, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
 
 int main() {
 
@@ -133,7 +155,216 @@ int main() {
             sum += Fraction(1, static_cast<uint64_t>(i));
         }
         std::cout << "1/1 + 1/2 + ... + 1/10 = " << sum.getInfo() << std::endl;
-        std::cout << "В виде double: " << static_cast<double>(sum) << std::endl;
+        std::cout << "В виде double: " << static_cast<double>(sum) << std::endl << std::endl;
+
+        std::cout << "13. МНОГОПОТОЧНОЕ НАКОПЛЕНИЕ:\n";
+        std::cout << "AtomicFraction без блокировок: " << (AtomicFraction::isLockFree() ? "да" : "нет") << std::endl;
+        const int totalAdds = 1 << 20;
+        const Fraction half(1, 2);
+        std::cout << std::setw(8) << "потоки" << std::setw(14) << "mutex, мс"
+                  << std::setw(14) << "atomic, мс" << std::setw(14) << "sharded, мс" << std::endl;
+        for (int threadCount = 1; threadCount <= 64; threadCount *= 2) {
+            const int perThread = totalAdds / threadCount;
+
+            Fraction locked;
+            std::mutex lockedGuard;
+            double lockedTime = measureThreads(threadCount, [&](int) {
+                for (int i = 0; i < perThread; i++) {
+                    std::lock_guard<std::mutex> lock(lockedGuard);
+                    locked += half;
+                }
+            });
+
+            AtomicFraction atomic;
+            double atomicTime = measureThreads(threadCount, [&](int) {
+                for (int i = 0; i < perThread; i++) {
+                    atomic += half;
+                }
+            });
+
+            ConcurrentFractionSum sharded;
+            double shardedTime = measureThreads(threadCount, [&](int) {
+                for (int i = 0; i < perThread; i++) {
+                    sharded += half;
+                }
+            });
+
+            if (locked != atomic.load() || locked != sharded.sum()) {
+                std::cout << "Расхождение сумм при " << threadCount << " потоках" << std::endl;
+            }
+            std::cout << std::fixed << std::setprecision(2)
+                      << std::setw(8) << threadCount << std::setw(14) << lockedTime
+                      << std::setw(14) << atomicTime << std::setw(14) << shardedTime << std::endl;
+        }
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6) << std::endl;
+
+        std::cout << "14. ПОТОКОВАЯ СТАТИСТИКА:\n";
+        FractionStatistics small;
+        for (int i = 1; i <= 10; i++) {
+            small += Fraction(i, static_cast<uint64_t>(i % 3 + 1));
+        }
+        std::cout << "count = " << small.count() << ", sum = " << small.sum()
+                  << ", mean = " << small.mean() << std::endl;
+        std::cout << "variance = " << small.variance() << ", sampleVariance = " << small.sampleVariance() << std::endl;
+        std::cout << "min = " << small.min() << ", max = " << small.max()
+                  << ", median ~ " << small.quantile(0.5) << std::endl;
+
+        // Для замера на 100M элементов установите streamLength = 100000000
+        const uint64_t streamLength = 10000000;
+        const int partCount = 4;
+        FractionStatistics whole;
+        std::vector<FractionStatistics> parts(partCount);
+        auto streamValue = [](uint64_t i) {
+            return Fraction(static_cast<int64_t>(i % 1000) - 500, i % 4 + 1);
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < streamLength; i++) {
+            whole += streamValue(i);
+        }
+        double wholeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        measureThreads(partCount, [&](int part) {
+            for (uint64_t i = part; i < streamLength; i += partCount) {
+                parts[part] += streamValue(i);
+            }
+        });
+        FractionStatistics merged;
+        for (const auto& part : parts) {
+            merged.merge(part);
+        }
+        double mergedTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Поток из " << streamLength << " элементов: " << wholeTime << " мс, "
+                  << partCount << " части + merge: " << mergedTime << " мс" << std::endl;
+        std::cout << "сумма точна: " << (whole.isSumExact() ? "да" : "нет")
+                  << ", дисперсия точна: " << (whole.isVarianceExact() ? "да" : "нет") << std::endl;
+        if (whole.isSumExact() && merged.isSumExact()) {
+            std::cout << "sum = " << whole.sum() << ", mean = " << whole.mean() << " / " << merged.mean() << std::endl;
+        }
+        std::cout << "mean ~ " << whole.meanApprox() << " / " << merged.meanApprox()
+                  << ", variance ~ " << whole.varianceApprox() << " / " << merged.varianceApprox() << std::endl;
+        std::cout << "квантили 0.1/0.5/0.9 ~ " << whole.quantile(0.1) << " / " << whole.quantile(0.5)
+                  << " / " << whole.quantile(0.9) << " (хранится " << whole.quantiles().retained() << " значений)" << std::endl;
+        std::cout << std::endl;
+
+        std::cout << "15. КОДЫ ОШИБОК:\n";
+        try {
+            Fraction big(std::numeric_limits<int64_t>::max());
+            ++big;
+        }
+        catch (const FractionException& e) {
+            std::cout << "код " << static_cast<int>(e.code()) << ": " << e.what() << std::endl;
+            FractionException::setLanguage(FractionLanguage::English);
+            std::cout << "English: " << FractionException::message(e.code()) << std::endl;
+            FractionException::setLanguage(FractionLanguage::Russian);
+        }
+
+        const int failureCount = 200000;
+        const Fraction zero;
+        const Fraction huge(std::numeric_limits<int64_t>::max(), 3);
+        std::vector<int> failuresByCode(static_cast<std::size_t>(FractionError::Count));
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < failureCount; i++) {
+            try {
+                Fraction result = (i % 2 == 0) ? f3 / zero : huge * huge;
+                (void)result;
+            }
+            catch (const FractionException& e) {
+                failuresByCode[static_cast<std::size_t>(e.code())]++;
+            }
+        }
+        double failureTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << failureCount << " ошибок: " << failureTime << " мс ("
+                  << failureTime * 1e6 / failureCount << " нс на ошибку), DivisionByZero = "
+                  << failuresByCode[static_cast<std::size_t>(FractionError::DivisionByZero)]
+                  << ", MultiplicationOverflow = "
+                  << failuresByCode[static_cast<std::size_t>(FractionError::MultiplicationOverflow)] << std::endl;
+        std::cout << std::endl;
+
+        std::cout << "16. ГРАНИЧНЫЕ СЛУЧАИ:\n";
+        Fraction nearMax(std::numeric_limits<int64_t>::max() - 1, std::numeric_limits<int64_t>::max());
+        std::cout << "(2^63-2)/(2^63-1) < 1: " << (nearMax < 1) << std::endl;
+        std::cout << "Fraction(0.1) = " << Fraction(0.1) << std::endl;
+        try {
+            Fraction wide = Fraction(1, 4294967296ULL) + Fraction(1, 4294967295ULL);
+            std::cout << "1/2^32 + 1/(2^32-1) = " << wide << std::endl;
+        }
+        catch (const FractionException& e) {
+            std::cout << "1/2^32 + 1/(2^32-1): " << e.what() << std::endl;
+        }
+        try {
+            Fraction tiny(1, std::numeric_limits<uint64_t>::max());
+            std::cout << "1/UINT64_MAX = " << tiny << std::endl;
+        }
+        catch (const FractionException& e) {
+            std::cout << "1/UINT64_MAX: " << e.what() << std::endl;
+        }
+        try {
+            Fraction inverse = !Fraction(std::numeric_limits<int64_t>::min());
+            std::cout << "!INT64_MIN = " << inverse << std::endl;
+        }
+        catch (const FractionException& e) {
+            std::cout << "!INT64_MIN: " << e.what() << std::endl;
+        }
+        std::cout << std::endl;
+
+        std::cout << "17. ПАКЕТНОЕ ПРЕОБРАЗОВАНИЕ:\n";
+        std::vector<Fraction> column = { Fraction(1, 3), Fraction(-5, 2), Fraction(7, 2), Fraction(2, 3), Fraction(-1, 8) };
+        std::vector<double> doubles(column.size());
+        std::vector<int64_t> fixed(column.size());
+        std::vector<int64_t> floors(column.size());
+        FractionConvert::toDouble(column, doubles);
+        FractionConvert::toFixedPoint(column, fixed, 4, RoundingMode::HalfEven);
+        FractionConvert::toInteger(column, floors, RoundingMode::Floor);
+        for (std::size_t i = 0; i < column.size(); i++) {
+            std::cout << column[i] << ": double = " << doubles[i] << ", x10^4 = " << fixed[i]
+                      << ", floor = " << floors[i] << std::endl;
+        }
+
+        const std::size_t columnSize = 1 << 20;
+        std::vector<Fraction> prices;
+        prices.reserve(columnSize);
+        for (std::size_t i = 0; i < columnSize; i++) {
+            prices.emplace_back(static_cast<int64_t>(i * 7919 % 1000003) - 500000, (i / 256) % 3 == 0 ? 100 : 3);
+        }
+        std::vector<double> priceDoubles(columnSize);
+        std::vector<int64_t> priceCents(columnSize);
+
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < columnSize; i++) {
+            priceDoubles[i] = static_cast<double>(prices[i]);
+        }
+        double scalarDoubleTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        FractionConvert::toDouble(prices, priceDoubles);
+        double batchDoubleTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Поэлементно то же округление к четному через / и % (числители здесь малы, умножение не переполняется)
+        std::vector<int64_t> scalarCents(columnSize);
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < columnSize; i++) {
+            int64_t scaled = prices[i].getNumerator() * 100;
+            int64_t den = static_cast<int64_t>(prices[i].getDenominator());
+            int64_t quotient = scaled / den;
+            int64_t twiceRemainder = 2 * std::abs(scaled % den);
+            if (twiceRemainder > den || (twiceRemainder == den && quotient % 2 != 0)) {
+                quotient += scaled < 0 ? -1 : 1;
+            }
+            scalarCents[i] = quotient;
+        }
+        double scalarIntTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        FractionConvert::toFixedPoint(prices, priceCents, 2, RoundingMode::HalfEven);
+        double batchIntTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << columnSize << " значений: double " << scalarDoubleTime << " / " << batchDoubleTime
+                  << " мс, x10^2 " << scalarIntTime << " / " << batchIntTime << " мс (поэлементно / пакетно), "
+                  << (scalarCents == priceCents ? "результаты совпадают" : "РЕЗУЛЬТАТЫ РАЗЛИЧАЮТСЯ") << std::endl;
 
     }
     catch (const FractionException& e) {